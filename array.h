@@ -1,101 +1,133 @@
 #ifndef _ARRAY_H_
 #define _ARRAY_H_
 
-#include <algorithm>
+#include <cstddef>               // size_t
+#include <iterator>              // reverse_iterator
+#include <stdexcept>             // out_of_range
+#include "constexpr_algorithm.h" // constexpr swap, fill, copy, compare, sort
+#include "simd_scan.h"           // vectorized find, count, min/max, sum, compare
 
 template<class T, std::size_t N = 16>
 struct array
 {
-	// Fixed size array of elements of type T.
+	// Fixed size array of elements of type T. Everything but the scans is constexpr, so
+	// arrays can be built, filled, sorted and compared at compile time.
 	T elements[N];
 
 	// Iterator support.
-	T* begin() { return elements; }
-	const T* begin() const { return elements; }
+	constexpr T* begin() { return elements; }
+	constexpr const T* begin() const { return elements; }
 	
-	T* end() { return elements + N; }
-	const T* end() const { return elements + N; }
+	constexpr T* end() { return elements + N; }
+	constexpr const T* end() const { return elements + N; }
 
 	// Reverse iterator support.
-	std::reverse_iterator<T*> rbegin() { return std::reverse_iterator<T*>(end()); }
-	std::reverse_iterator<const T*> rbegin() const { return std::reverse_iterator<const T*>(end()); }
-	std::reverse_iterator<const T*> crbegin() const { return std::reverse_iterator<const T*>(end()); }
+	constexpr std::reverse_iterator<T*> rbegin() { return std::reverse_iterator<T*>(end()); }
+	constexpr std::reverse_iterator<const T*> rbegin() const { return std::reverse_iterator<const T*>(end()); }
+	constexpr std::reverse_iterator<const T*> crbegin() const { return std::reverse_iterator<const T*>(end()); }
 	
-	std::reverse_iterator<T*> rend() { return std::reverse_iterator<T*>(begin()); }
-	std::reverse_iterator<const T*> rend() const { return std::reverse_iterator<const T*>(begin()); }
-	std::reverse_iterator<const T*> crend() const { return std::reverse_iterator<const T*>(begin()); }
+	constexpr std::reverse_iterator<T*> rend() { return std::reverse_iterator<T*>(begin()); }
+	constexpr std::reverse_iterator<const T*> rend() const { return std::reverse_iterator<const T*>(begin()); }
+	constexpr std::reverse_iterator<const T*> crend() const { return std::reverse_iterator<const T*>(begin()); }
 
-	T& operator[] (std::size_t i) { return elements[i]; }
-	const T& operator[] (std::size_t i) const { return elements[i]; }
+	constexpr T& operator[] (std::size_t i) { return elements[i]; }
+	constexpr const T& operator[] (std::size_t i) const { return elements[i]; }
 
 	// At performs a range check.
-	T& at(std::size_t i) 
+	constexpr T& at(std::size_t i) 
 	{ 
 		if (i >= size())
-			std::out_of_range("array<>: index out of range");
+			throw std::out_of_range("array<>: index out of range");
 		return elements[i];
 	}
 	
-	const T& at(std::size_t i) const 
+	constexpr const T& at(std::size_t i) const 
 	{ 
 		if (i >= size())
-			std::out_of_range("array<>: index out of range");
+			throw std::out_of_range("array<>: index out of range");
 		return elements[i];
 	}
 
-	T& front() { return elements[0]; }
-	const T& front() const { return elements[0]; }
+	constexpr T& front() { return elements[0]; }
+	constexpr const T& front() const { return elements[0]; }
 	
-	T& back() { return elements[N - 1]; }
-	const T& back() const { return elements[N - 1]; }
+	constexpr T& back() { return elements[N - 1]; }
+	constexpr const T& back() const { return elements[N - 1]; }
+
+	constexpr T* data() { return elements; }
+	constexpr const T* data() const { return elements; }
 
 	// Size is constant.
-	static std::size_t size() { return N; }
-	static std::size_t max_size() { return N; }
+	static constexpr std::size_t size() { return N; }
+	static constexpr std::size_t max_size() { return N; }
 	
-	static bool empty() { return false; }
+	static constexpr bool empty() { return false; }
 
-	void swap(array<T, N>& a)
+	constexpr void swap(array<T, N>& a)
 	{
 		for (std::size_t i = 0; i < N; ++i)
-			std::swap(elements[i], a.elements[i]);
+			cx::swap(elements[i], a.elements[i]);
 	}
 
 	// Assignment with type conversion.
 	template <typename T2>
-	array<T, N>& operator= (const array<T2, N>& rhs) 
+	constexpr array<T, N>& operator= (const array<T2, N>& rhs) 
 	{
-		std::copy(rhs.begin(), rhs.end(), begin());
+		cx::copy(rhs.begin(), rhs.end(), begin());
 		return *this;
 	}
 
 	// Assign one value to all elements.
-	void fill(const T& value) { std::fill_n(begin(), size(), value); }
+	constexpr void fill(const T& value) { cx::fill(begin(), end(), value); }
+
+	// Scans, vectorized for arithmetic T (see simd_scan.h).
+	T* find(const T& value) { return const_cast<T*>(simd::find(elements, elements + N, value)); }
+	const T* find(const T& value) const { return simd::find(elements, elements + N, value); }
+	std::size_t count_of(const T& value) const { return simd::count(elements, elements + N, value); }
+	bool contains(const T& value) const { return simd::contains(elements, elements + N, value); }
+	T* min_element() { return const_cast<T*>(simd::min_element(elements, elements + N)); }
+	const T* min_element() const { return simd::min_element(elements, elements + N); }
+	T* max_element() { return const_cast<T*>(simd::max_element(elements, elements + N)); }
+	const T* max_element() const { return simd::max_element(elements, elements + N); }
+	simd::sum_type<T> sum() const { return simd::sum(elements, elements + N); }
 };
 
-// Comparisons.
+// Comparisons. == is vectorized outside constant evaluation.
 template<class T, std::size_t N>
-bool operator== (const array<T, N>& x, const array<T, N>& y) 
+constexpr bool operator== (const array<T, N>& x, const array<T, N>& y) 
 {
-	return std::equal(x.begin(), x.end(), y.begin());
+	if (cx::is_constant_evaluated())
+		return cx::equal(x.begin(), x.end(), y.begin());
+	return simd::equal(x.begin(), x.end(), y.begin());
 }
 
 template<class T, std::size_t N>
-bool operator!= (const array<T, N>& x, const array<T, N>& y) { return !(x == y); }
+constexpr bool operator!= (const array<T, N>& x, const array<T, N>& y) { return !(x == y); }
 
 template<class T, std::size_t N>
-bool operator< (const array<T, N>& x, const array<T, N>& y) 
+constexpr bool operator< (const array<T, N>& x, const array<T, N>& y) 
 {
-	return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	return cx::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
 }
 
 template<class T, std::size_t N>
-bool operator> (const array<T, N>& x, const array<T, N>& y) { return y<x; }
+constexpr bool operator> (const array<T, N>& x, const array<T, N>& y) { return y<x; }
+
+template<class T, std::size_t N>
+constexpr bool operator<= (const array<T, N>& x, const array<T, N>& y) { return !(y<x); }
 
 template<class T, std::size_t N>
-bool operator<= (const array<T, N>& x, const array<T, N>& y) { return !(y<x); }
+constexpr bool operator>= (const array<T, N>& x, const array<T, N>& y) { return !(x<y); }
 
 template<class T, std::size_t N>
-bool operator>= (const array<T, N>& x, const array<T, N>& y) { return !(x<y); }
+constexpr void swap(array<T, N>& x, array<T, N>& y) { x.swap(y); }
+
+// Sorted copy, e.g. constexpr auto table = sorted(array<int, 4>{ { 3, 1, 2, 0 } });
+template<class T, std::size_t N, class Compare = std::less<>>
+constexpr array<T, N> sorted(array<T, N> a, Compare comp = Compare())
+{
+	cx::sort(a.begin(), a.end(), comp);
+	return a;
+}
 
 #endif
@@ -0,0 +1,112 @@
+// Helpers shared by the benchmark programs in this directory. Every benchmark is a single
+// source file built against the headers one level up, e.g.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread unbounded_queue_bench.cpp -o unbounded_queue_bench
+// Results go to stdout as aligned text, one line per measurement.
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <algorithm> // sort, max
+#include <atomic>    // atomic
+#include <chrono>    // steady_clock
+#include <cstddef>   // size_t
+#include <cstdio>    // printf
+#include <ctime>     // clock
+#include <thread>    // thread, hardware_concurrency
+#include <vector>    // vector
+
+namespace bench
+{
+	using clock = std::chrono::steady_clock;
+
+	inline double seconds_since(clock::time_point start)
+	{
+		return std::chrono::duration<double>(clock::now() - start).count();
+	}
+
+	// Wall time of one call to f, in seconds.
+	template <typename F>
+	double time(F&& f)
+	{
+		clock::time_point start = clock::now();
+		f();
+		return seconds_since(start);
+	}
+
+	// CPU time of the whole process so far, in seconds (all threads).
+	inline double cpu_seconds()
+	{
+		return double(std::clock()) / CLOCKS_PER_SEC;
+	}
+
+	// Keeps the compiler from discarding a result that is otherwise unused.
+	template <typename T>
+	void do_not_optimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const T* sink;
+		sink = &value;
+#endif
+	}
+
+	inline unsigned hardware_threads()
+	{
+		unsigned n = std::thread::hardware_concurrency();
+		return n ? n : 1;
+	}
+
+	// 1, 2, 4, ... up to max, with max itself always last.
+	inline std::vector<unsigned> thread_counts(unsigned max = hardware_threads())
+	{
+		std::vector<unsigned> counts;
+		for (unsigned n = 1; n < max; n *= 2)
+			counts.push_back(n);
+		counts.push_back(max);
+		return counts;
+	}
+
+	// Runs f(0) ... f(n - 1) on n threads released together; returns the wall time from the
+	// release until the last one has finished.
+	template <typename F>
+	double run_threads(unsigned n, F f)
+	{
+		std::atomic<unsigned> ready{ 0 };
+		std::atomic<bool> go{ false };
+		std::vector<std::thread> threads;
+		for (unsigned i = 0; i < n; ++i)
+			threads.emplace_back([&, i]
+			{
+				ready.fetch_add(1);
+				while (!go.load(std::memory_order_acquire))
+					std::this_thread::yield();
+				f(i);
+			});
+		while (ready.load() != n)
+			std::this_thread::yield();
+
+		clock::time_point start = clock::now();
+		go.store(true, std::memory_order_release);
+		for (std::thread& t : threads)
+			t.join();
+		return seconds_since(start);
+	}
+
+	// p in [0, 1]; sorts samples.
+	inline double percentile(std::vector<double>& samples, double p)
+	{
+		if (samples.empty())
+			return 0;
+		std::sort(samples.begin(), samples.end());
+		std::size_t i = std::size_t(p * double(samples.size() - 1) + 0.5);
+		return samples[i];
+	}
+
+	// One result line: a label, the operation count and the time they took.
+	inline void report(const char* label, double ops, double secs)
+	{
+		std::printf("%-48s %12.0f ops %10.3f ms %10.2f Mops/s %9.1f ns/op\n", label, ops, secs * 1e3, ops / secs * 1e-6, secs * 1e9 / std::max(ops, 1.0));
+	}
+}
+
+#endif
@@ -0,0 +1,89 @@
+// Scaling of the parallel_algorithm.h algorithms with the size of the parallel_pool.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread parallel_algorithm_bench.cpp -o parallel_algorithm_bench
+// Every algorithm runs over the same data with pools of 1 to hardware_concurrency() threads;
+// each line gives the best of a few runs and the speedup over the 1-thread pool.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include "bench.h"
+#include "parallel_algorithm.h"
+#include "vector.h"
+
+namespace
+{
+	const std::size_t elements = 1 << 23;
+	const int runs = 3;
+
+	vector<double> input()
+	{
+		vector<double> v;
+		v.reserve(elements);
+		std::size_t x = 88172645463325252ull;
+		for (std::size_t i = 0; i < elements; ++i)
+		{
+			x ^= x << 13;
+			x ^= x >> 7;
+			x ^= x << 17;
+			v.push_back(double(x % 1000000) * 1e-3);
+		}
+		return v;
+	}
+
+	// Best of runs; reset restores the data before each timed call.
+	template <typename Reset, typename F>
+	double best(Reset reset, F f)
+	{
+		double t = 1e30;
+		for (int r = 0; r < runs; ++r)
+		{
+			reset();
+			t = std::min(t, bench::time(f));
+		}
+		return t;
+	}
+
+	// base is the 1-thread time of the same algorithm; the first call sets it.
+	void line(const char* name, std::size_t threads, double secs, double& base)
+	{
+		if (threads == 1)
+			base = secs;
+		char label[96];
+		std::snprintf(label, sizeof(label), "%s threads=%zu (%.2fx)", name, threads, base / secs);
+		bench::report(label, double(elements), secs);
+	}
+}
+
+int main()
+{
+	const vector<double> data = input();
+	vector<double> work(data), out(data);
+	auto reset = [&] { work = data; };
+	auto none = [] { };
+
+	double baseForEach = 0, baseTransform = 0, baseReduce = 0, baseSort = 0, baseScan = 0;
+	for (std::size_t threads = 1; threads <= bench::hardware_threads(); ++threads)
+	{
+		parallel_pool pool(threads);
+		parallel_config cfg;
+		cfg.pool = &pool;
+
+		double t = best(reset, [&] { parallel_for_each(work.begin(), work.end(), [](double& x) { x = std::sqrt(x); }, cfg); });
+		line("parallel_for_each (sqrt)", threads, t, baseForEach);
+
+		t = best(none, [&] { parallel_transform(data.begin(), data.end(), out.begin(), [](double x) { return x * 1.5 + 1; }, cfg); });
+		line("parallel_transform", threads, t, baseTransform);
+
+		double sum = 0;
+		t = best(none, [&] { sum = parallel_reduce(data.begin(), data.end(), 0.0, std::plus<>(), cfg); });
+		bench::do_not_optimize(sum);
+		line("parallel_reduce", threads, t, baseReduce);
+
+		t = best(reset, [&] { parallel_sort(work.begin(), work.end(), std::less<>(), cfg); });
+		line("parallel_sort", threads, t, baseSort);
+
+		t = best(none, [&] { parallel_inclusive_scan(data.begin(), data.end(), out.begin(), std::plus<>(), cfg); });
+		line("parallel_inclusive_scan", threads, t, baseScan);
+	}
+	return 0;
+}
@@ -0,0 +1,68 @@
+// thread_safe_queue push_bulk/pop_bulk throughput across batch sizes and thread counts.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread queue_bulk_bench.cpp -o queue_bulk_bench
+// n producers and n consumers move a fixed number of elements through a 4096-slot queue.
+// Batch 1 uses plain push and pop; larger batches claim runs of slots with push_bulk and
+// pop_bulk. A side that finds the queue full or empty yields and retries.
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "lock_free_queue.h"
+
+namespace
+{
+	const std::size_t elements = 1 << 22;
+
+	void run(unsigned n, std::size_t batch)
+	{
+		thread_safe_queue<std::size_t> q(4096);
+		std::atomic<std::size_t> popped{ 0 };
+		std::size_t perProducer = elements / n;
+
+		double secs = bench::run_threads(2 * n, [&](unsigned i)
+		{
+			std::vector<std::size_t> buffer(batch);
+			if (i < n)
+			{
+				for (std::size_t k = 0; k < buffer.size(); ++k)
+					buffer[k] = k;
+				for (std::size_t sent = 0; sent < perProducer; )
+				{
+					std::size_t want = std::min(batch, perProducer - sent);
+					std::size_t done = batch == 1 ? std::size_t(q.push(buffer[0])) : q.push_bulk(buffer.begin(), buffer.begin() + want);
+					if (done == 0)
+						std::this_thread::yield();
+					sent += done;
+				}
+				return;
+			}
+			std::size_t sum = 0;
+			while (popped.load(std::memory_order_relaxed) < perProducer * n)
+			{
+				std::size_t done = batch == 1 ? std::size_t(q.pop(buffer[0])) : q.pop_bulk(buffer.begin(), batch);
+				if (done == 0)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				for (std::size_t k = 0; k < done; ++k)
+					sum += buffer[k];
+				popped.fetch_add(done, std::memory_order_relaxed);
+			}
+			bench::do_not_optimize(sum);
+		});
+
+		std::string label = std::to_string(n) + "p/" + std::to_string(n) + "c batch " + std::to_string(batch);
+		bench::report(label.c_str(), double(perProducer * n), secs);
+	}
+}
+
+int main()
+{
+	for (unsigned n : bench::thread_counts(std::max(1u, bench::hardware_threads() / 2)))
+		for (std::size_t batch : { 1, 4, 16, 64, 256 })
+			run(n, batch);
+	return 0;
+}
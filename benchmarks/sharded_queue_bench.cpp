@@ -0,0 +1,52 @@
+// sharded_queue scaling against a single thread_safe_queue, from 1 thread to the core count.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread sharded_queue_bench.cpp -o sharded_queue_bench
+// Every thread alternates push and pop on the shared queue, so all threads contend on both
+// ends. The sharded queues get one shard per hardware thread; the single queue has the same
+// total capacity.
+#include <string>
+#include <thread>
+#include "bench.h"
+#include "lock_free_queue.h"
+#include "sharded_queue.h"
+
+namespace
+{
+	const std::size_t pairs = 1 << 21; // push/pop pairs, split over the threads.
+	const std::size_t capacity = 1024; // Per shard.
+
+	template <typename Queue>
+	void run(const char* name, Queue& q, unsigned n)
+	{
+		std::size_t perThread = pairs / n;
+		double secs = bench::run_threads(n, [&](unsigned)
+		{
+			std::size_t v, sum = 0;
+			for (std::size_t k = 0; k < perThread; ++k)
+			{
+				while (!q.push(k))
+					std::this_thread::yield();
+				while (!q.pop(v))
+					std::this_thread::yield();
+				sum += v;
+			}
+			bench::do_not_optimize(sum);
+		});
+		std::string label = std::string(name) + " threads=" + std::to_string(n);
+		bench::report(label.c_str(), double(2 * perThread * n), secs);
+	}
+}
+
+int main()
+{
+	unsigned shards = bench::hardware_threads();
+	for (unsigned n : bench::thread_counts())
+	{
+		thread_safe_queue<std::size_t> single(capacity * shards);
+		sharded_queue<std::size_t> relaxed(capacity, shards);
+		sharded_queue<std::size_t, true> fifo(capacity, shards);
+		run("thread_safe_queue       ", single, n);
+		run("sharded_queue           ", relaxed, n);
+		run("sharded_queue<T, true>  ", fifo, n);
+	}
+	return 0;
+}
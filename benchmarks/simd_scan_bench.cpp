@@ -0,0 +1,76 @@
+// Scalar, SSE2 and AVX2 back ends of simd_scan.h side by side, per element type.
+//   g++ -std=c++17 -O2 -I.. simd_scan_bench.cpp -o simd_scan_bench
+// Build without -march=native so the scalar loops stay scalar (the compiler may still
+// vectorize some of them with SSE2). Each scan runs over a 64 KiB-ish array that stays in
+// cache, and the value looked for is absent, so find and == walk the whole range. Throughput
+// is in elements per second. == is timed through mismatch; simd::equal itself uses memcmp for
+// integer types. The AVX2 rows only appear when the CPU supports AVX2.
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "simd_scan.h"
+
+namespace
+{
+	const std::size_t total = std::size_t(1) << 27; // Elements scanned per measurement.
+
+	template <typename F>
+	void measure(const char* type, const char* op, const char* path, std::size_t n, F f)
+	{
+		std::size_t reps = total / n;
+		double secs = bench::time([&]
+		{
+			for (std::size_t r = 0; r < reps; ++r)
+				f();
+		});
+		std::string label = std::string(type) + ' ' + op + ' ' + path;
+		bench::report(label.c_str(), double(reps * n), secs);
+	}
+
+// One line per scan for the back end in namespace simd::detail::path.
+#define SIMD_SCAN_BENCH(path) \
+	measure(type, "find", #path, n, [&] { bench::do_not_optimize(simd::detail::path::find(first, last, missing)); }); \
+	measure(type, "count", #path, n, [&] { bench::do_not_optimize(simd::detail::path::count(first, last, missing)); }); \
+	measure(type, "min", #path, n, [&] { bench::do_not_optimize(simd::detail::path::min_element(first, last)); }); \
+	measure(type, "max", #path, n, [&] { bench::do_not_optimize(simd::detail::path::max_element(first, last)); }); \
+	measure(type, "sum", #path, n, [&] { bench::do_not_optimize(simd::detail::path::sum(first, last)); }); \
+	measure(type, "==", #path, n, [&] { bench::do_not_optimize(simd::detail::path::mismatch(first, last, other) == last); })
+
+	template <typename T>
+	void run(const char* type)
+	{
+		const std::size_t n = 65536 / sizeof(T) < 4096 ? 4096 : 65536 / sizeof(T);
+		std::vector<T> a(n), b;
+		for (std::size_t i = 0; i < n; ++i)
+			a[i] = T(i % 100);
+		b = a;
+		const T* first = a.data();
+		const T* last = first + n;
+		const T* other = b.data();
+		const T missing = T(101);
+
+		SIMD_SCAN_BENCH(scalar);
+#ifdef SIMD_SCAN_X86
+		SIMD_SCAN_BENCH(sse2);
+		if (simd::detail::has_avx2())
+		{
+			SIMD_SCAN_BENCH(avx2);
+		}
+#endif
+	}
+
+#undef SIMD_SCAN_BENCH
+}
+
+int main()
+{
+	run<std::int8_t>("int8  ");
+	run<std::int16_t>("int16 ");
+	run<std::int32_t>("int32 ");
+	run<std::int64_t>("int64 ");
+	run<float>("float ");
+	run<double>("double");
+	return 0;
+}
@@ -0,0 +1,83 @@
+// small_vector<T, 8> against vector<T>: heap allocations and time per container.
+//   g++ -std=c++17 -O2 -march=native -I.. small_vector_bench.cpp -o small_vector_bench
+// Builds many short-lived containers of k elements with push_back, sums them and destroys
+// them. Allocations are counted by replacing the global operator new; both containers get
+// their memory from std::allocator. Up to 8 elements small_vector should not allocate at all.
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "bench.h"
+#include "small_vector.h"
+#include "vector.h"
+
+namespace
+{
+	std::atomic<std::size_t> allocations{ 0 };
+}
+
+void* operator new(std::size_t n)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(n ? n : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+	const std::size_t containers = 1 << 18;
+
+	// 32 bytes, trivially copyable.
+	struct point
+	{
+		double x, y, z, w;
+		point(double v = 0) : x(v), y(v), z(v), w(v) { }
+		operator double() const { return x + y + z + w; }
+	};
+
+	template <typename Container>
+	void run(const char* name, std::size_t k)
+	{
+		double sum = 0;
+		std::size_t before = allocations.load();
+		double secs = bench::time([&]
+		{
+			for (std::size_t c = 0; c < containers; ++c)
+			{
+				Container v;
+				for (std::size_t i = 0; i < k; ++i)
+					v.push_back(typename Container::value_type(double(i + c)));
+				for (const auto& e : v)
+					sum += double(e);
+			}
+		});
+		bench::do_not_optimize(sum);
+		double perContainer = double(allocations.load() - before) / containers;
+
+		char label[96];
+		std::snprintf(label, sizeof(label), "%-22s k=%-3zu %5.2f allocs/container", name, k, perContainer);
+		bench::report(label, double(containers), secs);
+	}
+
+	template <typename T>
+	void compare(const char* type)
+	{
+		for (std::size_t k : { 1, 4, 8, 9, 16, 64 })
+		{
+			run<vector<T>>((std::string("vector<") + type + ">").c_str(), k);
+			run<small_vector<T, 8>>((std::string("small_vector<") + type + ", 8>").c_str(), k);
+		}
+	}
+}
+
+int main()
+{
+	compare<int>("int");
+	compare<point>("point");
+	return 0;
+}
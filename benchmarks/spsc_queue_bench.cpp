@@ -0,0 +1,100 @@
+// spsc_queue against thread_safe_queue with one producer and one consumer.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread spsc_queue_bench.cpp -o spsc_queue_bench
+// ping-pong:  two threads bounce a counter through a pair of queues; ops are round trips,
+//             and the label carries the median and 99th percentile of sampled trips.
+// throughput: one producer streams elements to one consumer through a 1024-slot queue.
+// Both sides spin on a failed push or pop, yielding now and then so the benchmark still
+// makes progress when the two threads share a core.
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "lock_free_queue.h"
+#include "spsc_queue.h"
+
+namespace
+{
+	const std::size_t trips = 200000;
+	const std::size_t elements = 1 << 24;
+
+	inline void backoff(unsigned& spins)
+	{
+		if (++spins % 64 == 0)
+			std::this_thread::yield();
+	}
+
+	template <typename Queue>
+	void push(Queue& q, std::size_t v)
+	{
+		for (unsigned spins = 0; !q.push(v); )
+			backoff(spins);
+	}
+
+	template <typename Queue>
+	std::size_t pop(Queue& q)
+	{
+		std::size_t v;
+		for (unsigned spins = 0; !q.pop(v); )
+			backoff(spins);
+		return v;
+	}
+
+	template <typename Queue>
+	void ping_pong(const char* name)
+	{
+		Queue there(64), back(64);
+		std::vector<double> samples;
+		samples.reserve(trips / 16);
+
+		std::thread echo([&]
+		{
+			for (std::size_t i = 0; i < trips; ++i)
+				push(back, pop(there));
+		});
+		double secs = bench::time([&]
+		{
+			for (std::size_t i = 0; i < trips; ++i)
+			{
+				bench::clock::time_point start = bench::clock::now();
+				push(there, i);
+				pop(back);
+				if (i % 16 == 0)
+					samples.push_back(bench::seconds_since(start) * 1e9);
+			}
+		});
+		echo.join();
+
+		char label[96];
+		std::snprintf(label, sizeof(label), "%s ping-pong p50 %.0f p99 %.0f ns", name, bench::percentile(samples, 0.5), bench::percentile(samples, 0.99));
+		bench::report(label, double(trips), secs);
+	}
+
+	template <typename Queue>
+	void throughput(const char* name)
+	{
+		Queue q(1024);
+		std::size_t sum = 0;
+		double secs = bench::run_threads(2, [&](unsigned i)
+		{
+			if (i == 0)
+				for (std::size_t k = 0; k < elements; ++k)
+					push(q, k);
+			else
+				for (std::size_t k = 0; k < elements; ++k)
+					sum += pop(q);
+		});
+		bench::do_not_optimize(sum);
+		std::string label = std::string(name) + " throughput";
+		bench::report(label.c_str(), double(elements), secs);
+	}
+}
+
+int main()
+{
+	ping_pong<spsc_queue<std::size_t>>("spsc_queue       ");
+	ping_pong<thread_safe_queue<std::size_t>>("thread_safe_queue");
+	throughput<spsc_queue<std::size_t>>("spsc_queue       ");
+	throughput<thread_safe_queue<std::size_t>>("thread_safe_queue");
+	return 0;
+}
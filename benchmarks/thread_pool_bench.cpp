@@ -0,0 +1,77 @@
+// thread_pool submission latency and throughput.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread thread_pool_bench.cpp -o thread_pool_bench
+// post:      one outside thread posts small (inline small_task) tasks, then drains the pool.
+// post_bulk: the same tasks posted 64 at a time.
+// submit:    submit a trivial task and wait for its future, one at a time; the label carries
+//            the p50/p99 of the time from post to the task starting and of the full round trip.
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include "bench.h"
+#include "thread_pool.h"
+
+namespace
+{
+	const std::size_t tasks = 1 << 20;
+	const std::size_t trips = 20000;
+
+	void throughput(unsigned workers)
+	{
+		thread_pool pool(workers);
+		std::atomic<std::size_t> done{ 0 };
+		auto task = [&done] { done.fetch_add(1, std::memory_order_relaxed); };
+
+		double secs = bench::time([&]
+		{
+			for (std::size_t i = 0; i < tasks; ++i)
+				pool.post(task);
+			pool.drain();
+		});
+		char label[96];
+		std::snprintf(label, sizeof(label), "post      workers=%u", workers);
+		bench::report(label, double(tasks), secs);
+
+		std::vector<decltype(task)> batch(64, task);
+		secs = bench::time([&]
+		{
+			for (std::size_t i = 0; i < tasks; i += batch.size())
+				pool.post_bulk(batch.begin(), batch.end());
+			pool.drain();
+		});
+		std::snprintf(label, sizeof(label), "post_bulk workers=%u", workers);
+		bench::report(label, double(tasks), secs);
+	}
+
+	void latency(unsigned workers)
+	{
+		thread_pool pool(workers);
+		std::vector<double> start, roundTrip;
+		start.reserve(trips);
+		roundTrip.reserve(trips);
+
+		double secs = bench::time([&]
+		{
+			for (std::size_t i = 0; i < trips; ++i)
+			{
+				bench::clock::time_point posted = bench::clock::now();
+				double started = pool.submit([posted] { return bench::seconds_since(posted); }).get();
+				start.push_back(started * 1e9);
+				roundTrip.push_back(bench::seconds_since(posted) * 1e9);
+			}
+		});
+		char label[96];
+		std::snprintf(label, sizeof(label), "submit    workers=%u start p50 %.0f trip p50 %.0f p99 %.0f ns", workers,
+			bench::percentile(start, 0.5), bench::percentile(roundTrip, 0.5), bench::percentile(roundTrip, 0.99));
+		bench::report(label, double(trips), secs);
+	}
+}
+
+int main()
+{
+	for (unsigned workers : bench::thread_counts())
+	{
+		throughput(workers);
+		latency(workers);
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+// Throughput of unbounded_queue against the bounded thread_safe_queue.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread unbounded_queue_bench.cpp -o unbounded_queue_bench
+// mpmc:  n producers and n consumers move a fixed number of elements through the queue; the
+//        bounded queue's producers wait (spin_yield_wait) while it is full.
+// burst: one thread pushes a whole batch, then pops it; the bounded queue is sized to fit,
+//        the unbounded one appends segments as it goes.
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include "bench.h"
+#include "lock_free_queue.h"
+#include "unbounded_queue.h"
+
+namespace
+{
+	const std::size_t elements = 4000000;
+
+	struct bounded
+	{
+		thread_safe_queue<std::size_t> q;
+		explicit bounded(std::size_t capacity = 1024) : q(capacity) { }
+		void push(std::size_t v) { q.wait_push(v); }
+		bool pop(std::size_t& v) { return q.pop(v); }
+	};
+
+	struct unbounded
+	{
+		unbounded_queue<std::size_t> q;
+		explicit unbounded(std::size_t = 0) { }
+		void push(std::size_t v) { q.push(v); }
+		bool pop(std::size_t& v) { return q.pop(v); }
+	};
+
+	template <typename Queue>
+	void mpmc(const char* name, unsigned n)
+	{
+		Queue queue;
+		std::atomic<std::size_t> popped{ 0 };
+		std::size_t perProducer = elements / n;
+		double secs = bench::run_threads(2 * n, [&](unsigned i)
+		{
+			if (i < n)
+			{
+				for (std::size_t k = 0; k < perProducer; ++k)
+					queue.push(k);
+				return;
+			}
+			std::size_t v, sum = 0;
+			while (popped.load(std::memory_order_relaxed) < perProducer * n)
+				if (queue.pop(v))
+				{
+					sum += v;
+					popped.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+					std::this_thread::yield();
+			bench::do_not_optimize(sum);
+		});
+		std::string label = std::string(name) + " mpmc " + std::to_string(n) + "p/" + std::to_string(n) + "c";
+		bench::report(label.c_str(), double(perProducer * n), secs);
+	}
+
+	template <typename Queue>
+	void burst(const char* name, std::size_t batch)
+	{
+		Queue queue(batch);
+		std::size_t rounds = elements / batch, v, sum = 0;
+		double secs = bench::time([&]
+		{
+			for (std::size_t r = 0; r < rounds; ++r)
+			{
+				for (std::size_t k = 0; k < batch; ++k)
+					queue.push(k);
+				for (std::size_t k = 0; k < batch && queue.pop(v); ++k)
+					sum += v;
+			}
+		});
+		bench::do_not_optimize(sum);
+		std::string label = std::string(name) + " burst " + std::to_string(batch);
+		bench::report(label.c_str(), double(2 * rounds * batch), secs);
+	}
+}
+
+int main()
+{
+	for (unsigned n : bench::thread_counts(std::max(1u, bench::hardware_threads() / 2)))
+	{
+		mpmc<bounded>("bounded  ", n);
+		mpmc<unbounded>("unbounded", n);
+	}
+	for (std::size_t batch : { 64, 1024, 65536 })
+	{
+		burst<bounded>("bounded  ", batch);
+		burst<unbounded>("unbounded", batch);
+	}
+	return 0;
+}
@@ -0,0 +1,75 @@
+// Wake-up latency and CPU cost of the wait strategies in wait_strategy.h.
+//   g++ -std=c++17 -O2 -march=native -I.. -pthread wait_strategy_bench.cpp -o wait_strategy_bench
+// Consumers block in thread_safe_queue::wait_pop while a producer pushes one timestamped
+// element every 200 us; the latency is the time from the push to the consumer holding the
+// element. cpu is the process CPU time over the wall time, i.e. how many cores the run kept
+// busy: the spinning strategies burn their waiters' cores, park_wait should stay near zero.
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "lock_free_queue.h"
+#include "wait_strategy.h"
+
+namespace
+{
+	const std::size_t pushes = 2000;
+	const std::chrono::microseconds interval(200);
+
+	std::size_t now_ns()
+	{
+		return std::size_t(std::chrono::duration_cast<std::chrono::nanoseconds>(bench::clock::now().time_since_epoch()).count());
+	}
+
+	template <typename Wait>
+	void run(const char* name, unsigned consumers)
+	{
+		const std::size_t stop = 0;
+		thread_safe_queue<std::size_t, false, Wait> q(64);
+		std::vector<double> latencies;
+		std::mutex m;
+
+		std::vector<std::thread> threads;
+		for (unsigned c = 0; c < consumers; ++c)
+			threads.emplace_back([&]
+			{
+				std::vector<double> local;
+				std::size_t stamp;
+				while (q.wait_pop(stamp) && stamp != stop)
+					local.push_back(double(now_ns() - stamp));
+				std::lock_guard<std::mutex> lock(m);
+				latencies.insert(latencies.end(), local.begin(), local.end());
+			});
+
+		double cpu = bench::cpu_seconds();
+		double wall = bench::time([&]
+		{
+			for (std::size_t i = 0; i < pushes; ++i)
+			{
+				std::this_thread::sleep_for(interval);
+				q.wait_push(now_ns());
+			}
+			for (unsigned c = 0; c < consumers; ++c)
+				q.wait_push(stop);
+			for (std::thread& t : threads)
+				t.join();
+		});
+		cpu = bench::cpu_seconds() - cpu;
+
+		std::printf("%-16s consumers %2u  latency p50 %8.0f ns  p99 %9.0f ns  cpu %5.2f cores\n", name, consumers,
+			bench::percentile(latencies, 0.5), bench::percentile(latencies, 0.99), cpu / wall);
+	}
+}
+
+int main()
+{
+	for (unsigned consumers : bench::thread_counts())
+	{
+		run<busy_spin_wait>("busy_spin_wait", consumers);
+		run<spin_yield_wait>("spin_yield_wait", consumers);
+		run<park_wait>("park_wait", consumers);
+	}
+	return 0;
+}
@@ -6,12 +6,16 @@
 #include <vector>
 #include <utility>
 #include <exception>
+#include <memory>
+#if (__cplusplus >= 201703L)
+#include <memory_resource> // polymorphic_allocator
+#endif
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<std::pair<std::size_t, T>>>
 struct maxheap
 {
 private:
-	std::vector<std::pair<std::size_t, T>> heap;
+	std::vector<std::pair<std::size_t, T>, Allocator> heap;
 
 	std::size_t parent(std::size_t i) { return (i - 1) / 2; }
 	std::size_t left(std::size_t i) { return (2 * i + 1); }
@@ -52,6 +56,13 @@ private:
 	}
 
 public:
+	using allocator_type = Allocator;
+
+	maxheap() { }
+	explicit maxheap(const Allocator& a) : heap(a) { }
+
+	allocator_type get_allocator() const { return heap.get_allocator(); }
+
 	std::size_t size() { return heap.size(); }
 	
 	bool empty() { return heap.size() == 0; }
@@ -100,4 +111,13 @@ public:
 	}
 };
 
+#if (__cplusplus >= 201703L)
+namespace pmr
+{
+	// Binary heap drawing its storage from a std::pmr::memory_resource.
+	template <typename T>
+	using maxheap = ::maxheap<T, std::pmr::polymorphic_allocator<std::pair<std::size_t, T>>>;
+}
+#endif
+
 #endif
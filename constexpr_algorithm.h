@@ -0,0 +1,206 @@
+// constexpr versions of the algorithms C++17 leaves non-constexpr (swap, fill, copy, equal,
+// lexicographical_compare, sort, ...), so tables can be built, sorted and searched at compile
+// time. Outside constant evaluation sort forwards to std::sort.
+#ifndef _CONSTEXPR_ALGORITHM_H_
+#define _CONSTEXPR_ALGORITHM_H_
+
+#include <algorithm>  // sort
+#include <cstddef>    // size_t
+#include <functional> // less
+#include <utility>    // move
+
+namespace cx
+{
+	// True during constant evaluation. Without compiler support it is always true, which
+	// keeps every caller on its constexpr path.
+	constexpr bool is_constant_evaluated() noexcept
+	{
+#if defined(__cpp_lib_is_constant_evaluated)
+		return std::is_constant_evaluated();
+#elif defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+		return __builtin_is_constant_evaluated();
+#else
+		return true;
+#endif
+	}
+
+	template <typename T>
+	constexpr void swap(T& a, T& b)
+	{
+		T t = std::move(a);
+		a = std::move(b);
+		b = std::move(t);
+	}
+
+	template <typename ForwardIt, typename T>
+	constexpr void fill(ForwardIt first, ForwardIt last, const T& value)
+	{
+		for (; first != last; ++first)
+			*first = value;
+	}
+
+	template <typename InputIt, typename OutIt>
+	constexpr OutIt copy(InputIt first, InputIt last, OutIt out)
+	{
+		for (; first != last; ++first, ++out)
+			*out = *first;
+		return out;
+	}
+
+	template <typename InputIt1, typename InputIt2>
+	constexpr bool equal(InputIt1 first1, InputIt1 last1, InputIt2 first2)
+	{
+		for (; first1 != last1; ++first1, ++first2)
+			if (!(*first1 == *first2))
+				return false;
+		return true;
+	}
+
+	template <typename InputIt1, typename InputIt2, typename Compare = std::less<>>
+	constexpr bool lexicographical_compare(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, Compare comp = Compare())
+	{
+		for (; first1 != last1 && first2 != last2; ++first1, ++first2)
+		{
+			if (comp(*first1, *first2))
+				return true;
+			if (comp(*first2, *first1))
+				return false;
+		}
+		return first1 == last1 && first2 != last2;
+	}
+
+	template <typename InputIt, typename T>
+	constexpr InputIt find(InputIt first, InputIt last, const T& value)
+	{
+		for (; first != last; ++first)
+			if (*first == value)
+				return first;
+		return last;
+	}
+
+	template <typename InputIt, typename Pred>
+	constexpr InputIt find_if(InputIt first, InputIt last, Pred pred)
+	{
+		for (; first != last; ++first)
+			if (pred(*first))
+				return first;
+		return last;
+	}
+
+	template <typename InputIt, typename T>
+	constexpr std::size_t count(InputIt first, InputIt last, const T& value)
+	{
+		std::size_t n = 0;
+		for (; first != last; ++first)
+			if (*first == value)
+				++n;
+		return n;
+	}
+
+	template <typename RandomIt, typename T, typename Compare = std::less<>>
+	constexpr RandomIt lower_bound(RandomIt first, RandomIt last, const T& value, Compare comp = Compare())
+	{
+		auto n = last - first;
+		while (n > 0)
+		{
+			auto half = n / 2;
+			if (comp(first[half], value))
+			{
+				first += half + 1;
+				n -= half + 1;
+			}
+			else
+				n = half;
+		}
+		return first;
+	}
+
+	template <typename RandomIt, typename T, typename Compare = std::less<>>
+	constexpr RandomIt upper_bound(RandomIt first, RandomIt last, const T& value, Compare comp = Compare())
+	{
+		auto n = last - first;
+		while (n > 0)
+		{
+			auto half = n / 2;
+			if (!comp(value, first[half]))
+			{
+				first += half + 1;
+				n -= half + 1;
+			}
+			else
+				n = half;
+		}
+		return first;
+	}
+
+	template <typename RandomIt, typename T, typename Compare = std::less<>>
+	constexpr bool binary_search(RandomIt first, RandomIt last, const T& value, Compare comp = Compare())
+	{
+		first = cx::lower_bound(first, last, value, comp);
+		return first != last && !comp(value, *first);
+	}
+
+	namespace detail
+	{
+		template <typename RandomIt, typename Compare>
+		constexpr void sift_down(RandomIt first, std::ptrdiff_t i, std::ptrdiff_t n, Compare& comp)
+		{
+			for (std::ptrdiff_t child = 2 * i + 1; child < n; i = child, child = 2 * i + 1)
+			{
+				if (child + 1 < n && comp(first[child], first[child + 1]))
+					++child;
+				if (!comp(first[i], first[child]))
+					return;
+				cx::swap(first[i], first[child]);
+			}
+		}
+
+		template <typename RandomIt, typename Compare>
+		constexpr void insertion_sort(RandomIt first, RandomIt last, Compare& comp)
+		{
+			for (RandomIt i = first; i != last; ++i)
+				for (RandomIt j = i; j != first && comp(*j, *(j - 1)); --j)
+					cx::swap(*j, *(j - 1));
+		}
+	}
+
+	// Heap sort during constant evaluation (insertion sort up to 16 elements), std::sort
+	// otherwise. Not stable.
+	template <typename RandomIt, typename Compare = std::less<>>
+	constexpr void sort(RandomIt first, RandomIt last, Compare comp = Compare())
+	{
+		if (!cx::is_constant_evaluated())
+		{
+			std::sort(first, last, comp);
+			return;
+		}
+
+		std::ptrdiff_t n = last - first;
+		if (n <= 16)
+		{
+			detail::insertion_sort(first, last, comp);
+			return;
+		}
+
+		for (std::ptrdiff_t i = n / 2; i-- > 0; )
+			detail::sift_down(first, i, n, comp);
+		for (std::ptrdiff_t end = n - 1; end > 0; --end)
+		{
+			cx::swap(first[0], first[end]);
+			detail::sift_down(first, 0, end, comp);
+		}
+	}
+
+	template <typename RandomIt, typename Compare = std::less<>>
+	constexpr bool is_sorted(RandomIt first, RandomIt last, Compare comp = Compare())
+	{
+		if (first == last)
+			return true;
+		for (RandomIt next = first + 1; next != last; ++first, ++next)
+			if (comp(*next, *first))
+				return false;
+		return true;
+	}
+}
+
+#endif
@@ -4,8 +4,15 @@
 #define DL_LIST_H
 
 #include <iostream>
+#include <functional> // less
+#include <memory>     // allocator_traits
+#include "list_sort.h"
+#include "radix_sort.h"
+#if (__cplusplus >= 201703L)
+#include <memory_resource> // polymorphic_allocator
+#endif
 
-template<typename T>
+template<typename T, typename Allocator = std::allocator<T>>
 class dlist
 {
 private:
@@ -20,6 +27,9 @@ private:
 		Node(T&& d, Node* p = nullptr, Node* n = nullptr) : data{ std::move(d) }, prev{ p }, next{ n } { }
 	};
 
+	using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+	using node_traits = std::allocator_traits<node_allocator>;
+
 public: 
 	// Nested const_iterator class.
 	class const_iterator 
@@ -38,7 +48,7 @@ public:
 		Node* current; // Current node const_iterator points at.
 		const_iterator(Node* p);
 
-		friend class dlist<T>;
+		friend class dlist<T, Allocator>;
 	};
 
 	// Nested iterator class.
@@ -56,45 +66,72 @@ public:
 
 	protected:
 		iterator(Node* p);
-		friend class dlist<T>;
+		friend class dlist<T, Allocator>;
 	};
 
 private:
 	void init() 
 	{
 		size_ = 0;
-		head = new Node;
-		tail = new Node;
+		head = create_node();
+		tail = create_node();
 		head->next = tail;
 		tail->prev = head;
 	}
 
+	template<typename ...Args>
+	Node* create_node(Args&&... args)
+	{
+		Node* n = node_traits::allocate(alloc, 1);
+		try
+		{
+			node_traits::construct(alloc, n, std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			node_traits::deallocate(alloc, n, 1);
+			throw;
+		}
+		return n;
+	}
+
+	void destroy_node(Node* n)
+	{
+		if (n == nullptr)
+			return;
+		node_traits::destroy(alloc, n);
+		node_traits::deallocate(alloc, n, 1);
+	}
+
 public:
+	using allocator_type = Allocator;
+
 	// Ctor.
 	dlist() { init(); }
+	explicit dlist(const Allocator& a) : alloc(a) { init(); }
 	// Copy ctor.
-	dlist(const dlist<T>& rhs)
+	dlist(const dlist<T, Allocator>& rhs) : alloc(node_traits::select_on_container_copy_construction(rhs.alloc))
 	{
 		init();
 		for (auto it = rhs.begin(); it != rhs.end(); ++it)
 			push_back(*it);
 	}
 	// Move ctor.
-	dlist(dlist<T>&& rhs) : size_(rhs.size_), head{ rhs.head }, tail{ rhs.tail }
+	dlist(dlist<T, Allocator>&& rhs) : size_(rhs.size_), head{ rhs.head }, tail{ rhs.tail }, alloc(std::move(rhs.alloc))
 	{
 		rhs.size_ = 0;
 		rhs.head = nullptr;
 		rhs.tail = nullptr;
 	}
 	// Copy assignment.
-	const dlist<T>& operator= (const dlist<T>& rhs)
+	const dlist<T, Allocator>& operator= (const dlist<T, Allocator>& rhs)
 	{
 		auto copy = rhs;
 		std::swap(*this, copy);
 		return *this;
 	}
 	// Move assignment.
-	dlist<T>& operator= (dlist<T>&& rhs)
+	dlist<T, Allocator>& operator= (dlist<T, Allocator>&& rhs)
 	{
 		init();
 		*this = std::move(rhs);
@@ -104,10 +141,12 @@ public:
 	~dlist()
 	{
 		clear();
-		delete head;
-		delete tail;
+		destroy_node(head);
+		destroy_node(tail);
 	}
 
+	allocator_type get_allocator() const { return allocator_type(alloc); }
+
 	int size() const;
 	bool empty() const;
 	void clear();
@@ -127,6 +166,17 @@ public:
 
 	void remove(const T& val);
 
+	// Stable radix sort by key(element), the element itself by default. Only relinks nodes.
+	template <typename Key = radix_identity>
+	void radix_sort(Key key = Key());
+	// Stable merge sort by comp. Only relinks nodes.
+	template <typename Compare = std::less<T>>
+	void sort(Compare comp = Compare());
+	// Merges the sorted list other into this sorted list and leaves other empty. Equal elements
+	// of this list come first. other must use an equal allocator.
+	template <typename Compare = std::less<T>>
+	void merge(dlist& other, Compare comp = Compare());
+
 	void print(std::ostream& os, char ofc = ' ') const;
 
 	iterator begin();
@@ -140,135 +190,149 @@ public:
 	// Erase from start to end, not including end, erase [start, end).
 	iterator erase(iterator start, iterator end);
 
+	// Move all nodes, the node at it, or [first, last) of other before pos. other must use an
+	// equal allocator. O(1), except that a range from another list is counted.
+	void splice(iterator pos, dlist& other);
+	void splice(iterator pos, dlist& other, iterator it);
+	void splice(iterator pos, dlist& other, iterator first, iterator last);
+
 private:
+	// Detaches the nodes between the sentinels as a null-terminated chain.
+	Node* unlink_all();
+	// Rebuilds prev links along the chain first and puts it between the sentinels.
+	void relink_all(Node* first);
+	// Unlinks [first, last) and links it before pos.
+	static void transfer(Node* pos, Node* first, Node* last);
+
 	int size_;  // Current number of nodes, except for head and tail.
 	Node *head, *tail; // Tail node.
+	node_allocator alloc;
 };
 
-template<typename T>
-bool operator== (const dlist<T>& lhs, const dlist<T>& rhs);
-template<typename T>
-bool operator!= (const dlist<T>& lhs, const dlist<T>& rhs);
+template<typename T, typename Allocator>
+bool operator== (const dlist<T, Allocator>& lhs, const dlist<T, Allocator>& rhs);
+template<typename T, typename Allocator>
+bool operator!= (const dlist<T, Allocator>& lhs, const dlist<T, Allocator>& rhs);
 
-template<typename T>
-std::ostream& operator<< (std::ostream& os, const dlist<T>& lst);
+template<typename T, typename Allocator>
+std::ostream& operator<< (std::ostream& os, const dlist<T, Allocator>& lst);
 	
-template<typename T>
-dlist<T>::const_iterator::const_iterator() : current{ nullptr } { }
+template<typename T, typename Allocator>
+dlist<T, Allocator>::const_iterator::const_iterator() : current{ nullptr } { }
 
-template<typename T>
-const T& dlist<T>::const_iterator::operator* () const { return current->data; }
+template<typename T, typename Allocator>
+const T& dlist<T, Allocator>::const_iterator::operator* () const { return current->data; }
 
-template<typename T>
-typename dlist<T>::const_iterator & dlist<T>::const_iterator::operator++ ()
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::const_iterator & dlist<T, Allocator>::const_iterator::operator++ ()
 {
 	current = current->next;
 	return *this;
 }
 
-template<typename T>
-typename dlist<T>::const_iterator dlist<T>::const_iterator::operator++ (int)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::const_iterator dlist<T, Allocator>::const_iterator::operator++ (int)
 {
 	auto copy = *this;
 	current = current->next;
 	return copy;
 }
 
-template<typename T>
-typename dlist<T>::const_iterator& dlist<T>::const_iterator::operator-- ()
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::const_iterator& dlist<T, Allocator>::const_iterator::operator-- ()
 {
 	current = current->prev;
 	return *this;
 }
 
-template<typename T>
-typename dlist<T>::const_iterator dlist<T>::const_iterator::operator-- (int)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::const_iterator dlist<T, Allocator>::const_iterator::operator-- (int)
 {
 	auto copy = *this;
 	current = current->prev;
 	return *this;
 }
 
-template<typename T>
-bool dlist<T>::const_iterator::operator== (const typename dlist<T>::const_iterator& rhs) const
+template<typename T, typename Allocator>
+bool dlist<T, Allocator>::const_iterator::operator== (const typename dlist<T, Allocator>::const_iterator& rhs) const
 {
 	return current == rhs.current;
 }
-template<typename T>
-bool dlist<T>::const_iterator::operator!= (const typename dlist<T>::const_iterator& rhs) const
+template<typename T, typename Allocator>
+bool dlist<T, Allocator>::const_iterator::operator!= (const typename dlist<T, Allocator>::const_iterator& rhs) const
 {
 	return current != rhs.current;
 }
 
-template<typename T>
-dlist<T>::const_iterator::const_iterator(typename dlist<T>::Node* p) : current{ p } { }
-template<typename T>
-dlist<T>::iterator::iterator() { }
+template<typename T, typename Allocator>
+dlist<T, Allocator>::const_iterator::const_iterator(typename dlist<T, Allocator>::Node* p) : current{ p } { }
+template<typename T, typename Allocator>
+dlist<T, Allocator>::iterator::iterator() { }
 
-template<typename T>
-T& dlist<T>::iterator::operator* () { return this->current->data; }
-template<typename T>
-const T& dlist<T>::iterator::operator* () const { return this->current->data; }
+template<typename T, typename Allocator>
+T& dlist<T, Allocator>::iterator::operator* () { return this->current->data; }
+template<typename T, typename Allocator>
+const T& dlist<T, Allocator>::iterator::operator* () const { return this->current->data; }
 
-template<typename T>
-typename dlist<T>::iterator& dlist<T>::iterator::operator++ ()
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator& dlist<T, Allocator>::iterator::operator++ ()
 {
 	this->current = this->current->next;
 	return *this;
 }
-template<typename T>
-typename dlist<T>::iterator dlist<T>::iterator::operator++ (int)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::iterator::operator++ (int)
 {
 	auto copy = *this;
 	this->current = this->current->next;
 	return copy;
 }
-template<typename T>
-typename dlist<T>::iterator& dlist<T>::iterator::operator-- ()
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator& dlist<T, Allocator>::iterator::operator-- ()
 {
 	this->current = this->current->prev;
 	return *this;
 }
-template<typename T>
-typename dlist<T>::iterator dlist<T>::iterator::operator-- (int)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::iterator::operator-- (int)
 {
 	auto copy = *this;
 	this->current = this->current->prev;
 	return *this;
 }
 
-template<typename T>
-dlist<T>::iterator::iterator(typename dlist<T>::Node* p) : dlist<T>::const_iterator{ p } { }
-
-template<typename T>
-int dlist<T>::size() const { return size_; }
-template<typename T>
-bool dlist<T>::empty() const { return size() == 0; }
-
-template<typename T>
-T& dlist<T>::front() { return *begin(); }
-template<typename T>
-const T & dlist<T>::front() const { return *begin(); }
-template<typename T>
-T& dlist<T>::back() { return *(--end()); }
-template<typename T>
-const T& dlist<T>::back() const { return *(--end()); }
-
-template<typename T>
-void dlist<T>::push_front(const T& val) { insert(begin(), val); }
-template<typename T>
-void dlist<T>::push_front(T&& val) { insert(begin(), std::move(val)); }
-template<typename T>
-void dlist<T>::push_back(const T& val) { insert(end(), val); }
-template<typename T>
-void dlist<T>::push_back(T&& val) { insert(end(), std::move(val)); }
-template<typename T>
-void dlist<T>::pop_front() { erase(begin()); }
-template<typename T>
-void dlist<T>::pop_back() { erase(--end()); }
-
-template<typename T>
-void dlist<T>::remove(const T& t)
+template<typename T, typename Allocator>
+dlist<T, Allocator>::iterator::iterator(typename dlist<T, Allocator>::Node* p) : dlist<T, Allocator>::const_iterator{ p } { }
+
+template<typename T, typename Allocator>
+int dlist<T, Allocator>::size() const { return size_; }
+template<typename T, typename Allocator>
+bool dlist<T, Allocator>::empty() const { return size() == 0; }
+
+template<typename T, typename Allocator>
+T& dlist<T, Allocator>::front() { return *begin(); }
+template<typename T, typename Allocator>
+const T & dlist<T, Allocator>::front() const { return *begin(); }
+template<typename T, typename Allocator>
+T& dlist<T, Allocator>::back() { return *(--end()); }
+template<typename T, typename Allocator>
+const T& dlist<T, Allocator>::back() const { return *(--end()); }
+
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::push_front(const T& val) { insert(begin(), val); }
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::push_front(T&& val) { insert(begin(), std::move(val)); }
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::push_back(const T& val) { insert(end(), val); }
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::push_back(T&& val) { insert(end(), std::move(val)); }
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::pop_front() { erase(begin()); }
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::pop_back() { erase(--end()); }
+
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::remove(const T& t)
 {
 	for (auto it = begin(); it != end(); ++it)
 		if (*it == t) 
@@ -278,108 +342,217 @@ void dlist<T>::remove(const T& t)
 		}
 }
 
-template<typename T>
-typename dlist<T>::iterator dlist<T>::begin()
+template<typename T, typename Allocator>
+template<typename Key>
+void dlist<T, Allocator>::radix_sort(Key key)
 {
-	if (!empty())
-	{
-		typename dlist<T>::iterator it{ head->next };
-		return it;
-	}
-	else
-		return nullptr;
+	if (size_ < 2)
+		return;
+
+	Node* first = unlink_all();
+	radix_sort_nodes(first, [](Node* n) -> Node*& { return n->next; }, [&key](Node* n) { return key(n->data); });
+	relink_all(first);
 }
-template<typename T>
-typename dlist<T>::const_iterator dlist<T>::begin() const
+
+template<typename T, typename Allocator>
+template<typename Compare>
+void dlist<T, Allocator>::sort(Compare comp)
 {
-	if (!empty())
+	if (size_ < 2)
+		return;
+
+	Node* first = unlink_all();
+	merge_sort_chain(first, [](Node* n) -> Node*& { return n->next; }, [&comp](Node* a, Node* b) { return comp(a->data, b->data); });
+	relink_all(first);
+}
+
+template<typename T, typename Allocator>
+template<typename Compare>
+void dlist<T, Allocator>::merge(dlist<T, Allocator>& other, Compare comp)
+{
+	if (&other == this || other.empty())
+		return;
+
+	Node* a = unlink_all();
+	Node* b = other.unlink_all();
+	relink_all(merge_chains(a, b, [](Node* n) -> Node*& { return n->next; }, [&comp](Node* x, Node* y) { return comp(x->data, y->data); }));
+	size_ += other.size_;
+	other.size_ = 0;
+}
+
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::splice(typename dlist<T, Allocator>::iterator pos, dlist<T, Allocator>& other)
+{
+	if (&other == this || other.empty())
+		return;
+
+	transfer(pos.current, other.head->next, other.tail);
+	size_ += other.size_;
+	other.size_ = 0;
+}
+
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::splice(typename dlist<T, Allocator>::iterator pos, dlist<T, Allocator>& other, typename dlist<T, Allocator>::iterator it)
+{
+	Node* n = it.current;
+	if (n == pos.current || n->next == pos.current)
+		return;
+
+	transfer(pos.current, n, n->next);
+	++size_;
+	--other.size_;
+}
+
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::splice(typename dlist<T, Allocator>::iterator pos, dlist<T, Allocator>& other, typename dlist<T, Allocator>::iterator first, typename dlist<T, Allocator>::iterator last)
+{
+	if (first == last)
+		return;
+
+	if (&other != this)
 	{
-		typename dlist<T>::const_iterator constIt{ head->next };
-		return constIt;
+		int n = 0;
+		for (Node* p = first.current; p != last.current; p = p->next)
+			++n;
+		size_ += n;
+		other.size_ -= n;
 	}
-	else
+	transfer(pos.current, first.current, last.current);
+}
+
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::Node* dlist<T, Allocator>::unlink_all()
+{
+	Node* first = head->next;
+	if (first == tail)
 		return nullptr;
+
+	tail->prev->next = nullptr;
+	head->next = tail;
+	tail->prev = head;
+	return first;
 }
 
-template<typename T>
-typename dlist<T>::iterator dlist<T>::end()
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::relink_all(typename dlist<T, Allocator>::Node* first)
 {
-	typename dlist<T>::iterator it{ tail };
+	Node* prev = head;
+	for (Node* p = first; p; prev = p, p = p->next)
+		p->prev = prev;
+	head->next = first ? first : tail;
+	prev->next = tail;
+	tail->prev = prev;
+}
+
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::transfer(typename dlist<T, Allocator>::Node* pos, typename dlist<T, Allocator>::Node* first, typename dlist<T, Allocator>::Node* last)
+{
+	if (pos == last)
+		return;
+
+	Node* back = last->prev;
+	first->prev->next = last;
+	last->prev = first->prev;
+
+	first->prev = pos->prev;
+	back->next = pos;
+	pos->prev->next = first;
+	pos->prev = back;
+}
+
+// The first node after the head sentinel: the tail sentinel (end()) when the list is empty.
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::begin()
+{
+	typename dlist<T, Allocator>::iterator it{ head->next };
 	return it;
 }
-template<typename T>
-typename dlist<T>::const_iterator dlist<T>::end() const
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::const_iterator dlist<T, Allocator>::begin() const
 {
-	typename dlist<T>::const_iterator constIt{ tail };
+	typename dlist<T, Allocator>::const_iterator constIt{ head->next };
 	return constIt;
 }
 
-template<typename T>
-typename dlist<T>::iterator dlist<T>::insert(typename dlist<T>::iterator it, const T& val)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::end()
+{
+	typename dlist<T, Allocator>::iterator it{ tail };
+	return it;
+}
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::const_iterator dlist<T, Allocator>::end() const
+{
+	typename dlist<T, Allocator>::const_iterator constIt{ tail };
+	return constIt;
+}
+
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::insert(typename dlist<T, Allocator>::iterator it, const T& val)
 {
 	auto* p = it.current;
 
 	size_++;
 
-	auto* nptr = new dlist<T>::Node{ val, p->prev, p };
+	auto* nptr = create_node(val, p->prev, p);
 
 	p->prev->next = nptr;
 	p->prev = nptr;
 
-	typename dlist<T>::iterator iter{ nptr };
+	typename dlist<T, Allocator>::iterator iter{ nptr };
 
 	return iter;
 }
 
-template<typename T>
-typename dlist<T>::iterator dlist<T>::insert(typename dlist<T>::iterator it, T&& val)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::insert(typename dlist<T, Allocator>::iterator it, T&& val)
 {
 	auto* p = it.current;
 
 	size_++;
 
-	auto* nptr = new dlist<T>::Node{ std::move(val), p->prev, p };
+	auto* nptr = create_node(std::move(val), p->prev, p);
 
 	p->prev->next = nptr;
 	p->prev = nptr;
 
-	typename dlist<T>::iterator iter{ nptr };
+	typename dlist<T, Allocator>::iterator iter{ nptr };
 
 	return iter;
 }
 
-template<typename T>
-typename dlist<T>::iterator dlist<T>::erase(typename dlist<T>::iterator it)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::erase(typename dlist<T, Allocator>::iterator it)
 {
 	auto* p = it.current;
-	typename dlist<T>::iterator retVal{ p->next };
+	typename dlist<T, Allocator>::iterator retVal{ p->next };
 
 	p->prev->next = p->next;
 	p->next->prev = p->prev;
 
-	delete p;
+	destroy_node(p);
 	size_--;
 
 	return retVal;
 }
 
-template<typename T>
-typename dlist<T>::iterator dlist<T>::erase(typename dlist<T>::iterator start, typename dlist<T>::iterator end)
+template<typename T, typename Allocator>
+typename dlist<T, Allocator>::iterator dlist<T, Allocator>::erase(typename dlist<T, Allocator>::iterator start, typename dlist<T, Allocator>::iterator end)
 {
 	for (auto it = start; it != end;)
 		it = erase(it);
 	return end;
 }
 
-template<typename T>
-void dlist<T>::clear()
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::clear()
 {
 	while (!empty())
 		pop_back();
 }
 
-template<typename T>
-void dlist<T>::reverse()
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::reverse()
 {
 	if (!empty())
 	{
@@ -395,8 +568,8 @@ void dlist<T>::reverse()
 	std::swap(head, tail);
 }
 
-template<typename T>
-bool operator== (const dlist<T>& lhs, const dlist<T>& rhs)
+template<typename T, typename Allocator>
+bool operator== (const dlist<T, Allocator>& lhs, const dlist<T, Allocator>& rhs)
 {
 	bool flag = true;
 
@@ -420,20 +593,29 @@ bool operator== (const dlist<T>& lhs, const dlist<T>& rhs)
 	return false;
 }
 
-template<typename T>
-bool operator!= (const dlist<T>& lhs, const dlist<T>& rhs) { return !(lhs == rhs); }
+template<typename T, typename Allocator>
+bool operator!= (const dlist<T, Allocator>& lhs, const dlist<T, Allocator>& rhs) { return !(lhs == rhs); }
 
-template<typename T>
-void dlist<T>::print(std::ostream& os, char ofc) const
+template<typename T, typename Allocator>
+void dlist<T, Allocator>::print(std::ostream& os, char ofc) const
 {
 	for (auto it = begin(); it != end(); ++it)
 		os << *it << ofc;
 }
 
-template<typename T>
-std::ostream& operator<< (std::ostream& os, const dlist<T>& list)
+template<typename T, typename Allocator>
+std::ostream& operator<< (std::ostream& os, const dlist<T, Allocator>& list)
 {
 	list.print(os);
 	return os;
 }
+
+#if (__cplusplus >= 201703L)
+namespace pmr
+{
+	// Doubly-linked list drawing its nodes from a std::pmr::memory_resource.
+	template <typename T>
+	using dlist = ::dlist<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
 #endif
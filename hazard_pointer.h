@@ -0,0 +1,179 @@
+// Hazard pointers: safe memory reclamation for lock-free structures. A reader publishes the
+// pointer it is about to dereference with hazard::protect; a writer that unlinked an object
+// hands it to hazard::retire, which deletes it once no thread's hazard slot holds it.
+// Every thread owns a record of slots_per_thread slots, taken on first use and returned when
+// the thread exits; objects still protected at that point are handed to the next scan.
+#ifndef _HAZARD_POINTER_H_
+#define _HAZARD_POINTER_H_
+
+#include <algorithm> // sort, binary_search
+#include <atomic>    // atomic
+#include <cstddef>   // size_t
+#include "vector.h"
+
+namespace hazard
+{
+	constexpr unsigned slots_per_thread = 2;
+
+	namespace detail
+	{
+		struct record
+		{
+			std::atomic<void*> slot[slots_per_thread];
+			std::atomic<bool> active{ true };
+			record* next = nullptr;
+
+			record()
+			{
+				for (auto& s : slot)
+					s.store(nullptr, std::memory_order_relaxed);
+			}
+		};
+
+		struct retired
+		{
+			void* p;
+			void (*deleter)(void*);
+		};
+
+		struct orphan
+		{
+			retired r;
+			orphan* next;
+		};
+
+		// Process-wide list of records; records are reused, never freed.
+		struct domain
+		{
+			std::atomic<record*> records{ nullptr };
+			std::atomic<std::size_t> recordCount{ 0 };
+			std::atomic<orphan*> orphans{ nullptr };
+
+			static domain& instance()
+			{
+				static domain d;
+				return d;
+			}
+
+			record* acquire()
+			{
+				for (record* r = records.load(std::memory_order_acquire); r; r = r->next)
+				{
+					bool idle = false;
+					if (!r->active.load(std::memory_order_relaxed) && r->active.compare_exchange_strong(idle, true, std::memory_order_acquire))
+						return r;
+				}
+
+				record* r = new record;
+				r->next = records.load(std::memory_order_relaxed);
+				while (!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed));
+				recordCount.fetch_add(1, std::memory_order_relaxed);
+				return r;
+			}
+		};
+
+		struct thread_state
+		{
+			record* rec = nullptr;
+			vector<retired> retiredList;
+
+			record& get()
+			{
+				if (!rec)
+					rec = domain::instance().acquire();
+				return *rec;
+			}
+
+			// Deletes every retired object no hazard slot holds.
+			void scan()
+			{
+				domain& d = domain::instance();
+
+				for (orphan* o = d.orphans.exchange(nullptr, std::memory_order_acquire); o; )
+				{
+					orphan* next = o->next;
+					retiredList.push_back(o->r);
+					delete o;
+					o = next;
+				}
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				vector<void*> hazards;
+				for (record* r = d.records.load(std::memory_order_acquire); r; r = r->next)
+					for (auto& s : r->slot)
+						if (void* p = s.load(std::memory_order_seq_cst))
+							hazards.push_back(p);
+				std::sort(hazards.begin(), hazards.end());
+
+				vector<retired> keep;
+				for (retired& r : retiredList)
+				{
+					if (std::binary_search(hazards.begin(), hazards.end(), r.p))
+						keep.push_back(r);
+					else
+						r.deleter(r.p);
+				}
+				retiredList.swap(keep);
+			}
+
+			~thread_state()
+			{
+				if (!rec)
+					return;
+
+				for (auto& s : rec->slot)
+					s.store(nullptr, std::memory_order_release);
+				scan();
+
+				domain& d = domain::instance();
+				for (retired& r : retiredList)
+				{
+					orphan* o = new orphan{ r, d.orphans.load(std::memory_order_relaxed) };
+					while (!d.orphans.compare_exchange_weak(o->next, o, std::memory_order_release, std::memory_order_relaxed));
+				}
+				rec->active.store(false, std::memory_order_release);
+			}
+		};
+
+		inline thread_state& local()
+		{
+			static thread_local thread_state state;
+			return state;
+		}
+	}
+
+	// Loads src and keeps the loaded object alive until slot i is cleared or reused.
+	template <typename T>
+	T* protect(const std::atomic<T*>& src, unsigned i = 0)
+	{
+		std::atomic<void*>& slot = detail::local().get().slot[i];
+		T* p = src.load(std::memory_order_acquire);
+		for (;;)
+		{
+			slot.store(p, std::memory_order_seq_cst);
+			T* q = src.load(std::memory_order_acquire);
+			if (q == p)
+				return p;
+			p = q;
+		}
+	}
+
+	inline void clear(unsigned i = 0)
+	{
+		detail::local().get().slot[i].store(nullptr, std::memory_order_release);
+	}
+
+	// Deletes p once no thread protects it. p must already be unreachable for new readers.
+	template <typename T>
+	void retire(T* p)
+	{
+		detail::thread_state& st = detail::local();
+		st.retiredList.push_back(detail::retired{ p, [](void* q) { delete static_cast<T*>(q); } });
+
+		std::size_t threshold = 2 * slots_per_thread * detail::domain::instance().recordCount.load(std::memory_order_relaxed);
+		if (st.retiredList.size() >= (threshold < 8 ? 8 : threshold))
+			st.scan();
+	}
+}
+
+#endif
@@ -0,0 +1,189 @@
+// Allocator for very large vectors. Each allocation reserves a big range of address space up
+// front and commits pages only as the vector grows into it, so growth never copies and never
+// needs old and new buffers at the same time. Shrinking returns the pages to the OS
+// (MADV_DONTNEED / MEM_DECOMMIT). Transparent huge pages are requested with MADV_HUGEPAGE
+// where available.
+#ifndef _LARGE_VECTOR_H_
+#define _LARGE_VECTOR_H_
+
+#include <cstddef> // size_t
+#include <new>     // bad_alloc
+#include "vector.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace virtual_memory
+{
+	inline std::size_t page_size()
+	{
+#if defined(_WIN32)
+		static const std::size_t size = [] { SYSTEM_INFO info; GetSystemInfo(&info); return std::size_t(info.dwPageSize); }();
+#else
+		static const std::size_t size = std::size_t(sysconf(_SC_PAGESIZE));
+#endif
+		return size;
+	}
+
+	inline std::size_t round_up(std::size_t n) { return (n + page_size() - 1) & ~(page_size() - 1); }
+
+	// Address space only, nothing is committed.
+	inline void* reserve(std::size_t n, bool hugePages)
+	{
+#if defined(_WIN32)
+		(void)hugePages;
+		return VirtualAlloc(nullptr, n, MEM_RESERVE, PAGE_NOACCESS);
+#else
+		void* p = mmap(nullptr, n, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (p == MAP_FAILED)
+			return nullptr;
+#if defined(MADV_HUGEPAGE)
+		if (hugePages)
+			madvise(p, n, MADV_HUGEPAGE);
+#else
+		(void)hugePages;
+#endif
+		return p;
+#endif
+	}
+
+	inline void release(void* p, std::size_t n)
+	{
+#if defined(_WIN32)
+		(void)n;
+		VirtualFree(p, 0, MEM_RELEASE);
+#else
+		munmap(p, n);
+#endif
+	}
+
+	// Makes [p, p + n) usable. Physical pages are still only assigned when first touched.
+	inline bool commit(void* p, std::size_t n)
+	{
+#if defined(_WIN32)
+		return VirtualAlloc(p, n, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+		return mprotect(p, n, PROT_READ | PROT_WRITE) == 0;
+#endif
+	}
+
+	// Returns the pages of [p, p + n) to the OS, keeping the address range reserved.
+	inline void decommit(void* p, std::size_t n)
+	{
+#if defined(_WIN32)
+		VirtualFree(p, n, MEM_DECOMMIT);
+#else
+		madvise(p, n, MADV_DONTNEED);
+		mprotect(p, n, PROT_NONE);
+#endif
+	}
+}
+
+// Each block starts with a header page recording its reservation; elements follow it.
+// Blocks larger than the configured reservation are reserved at their own size (rounded to
+// pages) and can then only grow into the rounding.
+template <typename T>
+class mmap_allocator
+{
+	template <typename U> friend class mmap_allocator;
+
+	struct header
+	{
+		std::size_t reserved;  // Bytes of address space, header included.
+		std::size_t committed; // Bytes committed, header included.
+	};
+
+	std::size_t reserveSize; // Address space reserved per allocation.
+	bool hugePages;
+
+	static std::size_t offset() { return virtual_memory::round_up(sizeof(header)); }
+	static header* header_of(T* p) { return reinterpret_cast<header*>(reinterpret_cast<char*>(p) - offset()); }
+
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+	using is_always_equal = std::true_type; // Blocks are self-describing, any instance frees them.
+
+	// 64 GiB of address space per vector by default; this costs no memory.
+	static constexpr std::size_t default_reserve = std::size_t(1) << (sizeof(void*) >= 8 ? 36 : 28);
+
+	explicit mmap_allocator(std::size_t reserveBytes = default_reserve, bool useHugePages = true) noexcept
+		: reserveSize(reserveBytes), hugePages(useHugePages) { }
+
+	template <typename U>
+	mmap_allocator(const mmap_allocator<U>& rhs) noexcept : reserveSize(rhs.reserveSize), hugePages(rhs.hugePages) { }
+
+	std::size_t reserve_size() const noexcept { return reserveSize; }
+	bool huge_pages() const noexcept { return hugePages; }
+
+	T* allocate(std::size_t n)
+	{
+		if (n > (std::size_t(-1) - 2 * offset()) / sizeof(T))
+			throw std::bad_alloc();
+
+		std::size_t used = virtual_memory::round_up(offset() + n * sizeof(T));
+		std::size_t reserved = (std::max)(used, virtual_memory::round_up(reserveSize));
+		char* base = static_cast<char*>(virtual_memory::reserve(reserved, hugePages));
+
+		if (!base)
+			throw std::bad_alloc();
+		if (!virtual_memory::commit(base, used))
+		{
+			virtual_memory::release(base, reserved);
+			throw std::bad_alloc();
+		}
+
+		header* h = reinterpret_cast<header*>(base);
+		h->reserved = reserved;
+		h->committed = used;
+		return reinterpret_cast<T*>(base + offset());
+	}
+
+	void deallocate(T* p, std::size_t) noexcept
+	{
+		header* h = header_of(p);
+		virtual_memory::release(h, h->reserved);
+	}
+
+	// Commits or decommits pages so the block holds n elements; fails if n does not fit the
+	// reservation. Used by vector to grow and shrink without moving the elements.
+	bool resize_in_place(T* p, std::size_t, std::size_t n) noexcept
+	{
+		header* h = header_of(p);
+		char* base = reinterpret_cast<char*>(h);
+
+		if (n > (h->reserved - offset()) / sizeof(T))
+			return false;
+
+		std::size_t used = virtual_memory::round_up(offset() + n * sizeof(T));
+
+		if (used > h->committed)
+		{
+			if (!virtual_memory::commit(base + h->committed, used - h->committed))
+				return false;
+		}
+		else if (used < h->committed)
+			virtual_memory::decommit(base + used, h->committed - used);
+
+		h->committed = used;
+		return true;
+	}
+};
+
+template <typename T, typename U>
+bool operator== (const mmap_allocator<T>&, const mmap_allocator<U>&) noexcept { return true; }
+
+template <typename T, typename U>
+bool operator!= (const mmap_allocator<T>&, const mmap_allocator<U>&) noexcept { return false; }
+
+// vector whose storage grows in place inside a reserved address range.
+template <typename T>
+using large_vector = vector<T, mmap_allocator<T>>;
+
+#endif
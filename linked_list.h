@@ -2,27 +2,62 @@
 #define _BASIC_LIST_H_
 
 #include <iostream>  // cout
-#include <exception> // out_of_range
+#include <exception>  // out_of_range
+#include <functional> // less
+#include <memory>     // allocator_traits
+#include "list_sort.h"
+#include "radix_sort.h"
+#if (__cplusplus >= 201703L)
+#include <memory_resource> // polymorphic_allocator
+#endif
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class list
 {
 	struct node
 	{
-		template <typename T> friend class list;
-
-		explicit node(T e) : next(nullptr) { element = e; }
+		explicit node(const T& e) : element(e), next(nullptr) { }
 
 		T element;
 		node* next;
 	};
 
+	using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+	using node_traits = std::allocator_traits<node_allocator>;
+
 	node *head, *tail;
+	node_allocator alloc;
+
+	node* create_node(const T& e)
+	{
+		node* n = node_traits::allocate(alloc, 1);
+		try
+		{
+			node_traits::construct(alloc, n, e);
+		}
+		catch (...)
+		{
+			node_traits::deallocate(alloc, n, 1);
+			throw;
+		}
+		return n;
+	}
+
+	void destroy_node(node* n)
+	{
+		node_traits::destroy(alloc, n);
+		node_traits::deallocate(alloc, n, 1);
+	}
 
 public:
+	using allocator_type = Allocator;
+
 	list() : head(nullptr), tail(nullptr) { }
+	explicit list(const Allocator& a) : head(nullptr), tail(nullptr), alloc(a) { }
 	~list() { clear(); }
 
+	allocator_type get_allocator() const { return allocator_type(alloc); }
+
 	void clear()
 	{
 		while (!empty())
@@ -58,7 +93,7 @@ public:
 
 	void push_back(const T& e)
 	{
-		node *newNode = new node(e);
+		node *newNode = create_node(e);
 
 		if (!head)
 			head = newNode;
@@ -71,7 +106,7 @@ public:
 
 	void push_front(const T& e)
 	{
-		node *newNode = new node(e);
+		node *newNode = create_node(e);
 
 		if (!tail)
 			tail = newNode;
@@ -92,7 +127,7 @@ public:
 		if (tail == temp)
 			tail = nullptr;
 
-		delete temp;
+		destroy_node(temp);
 	}
 
 	bool find(const T& d) const
@@ -136,7 +171,7 @@ public:
 
 			prev->next = curr->next;
 
-			delete curr;
+			destroy_node(curr);
 		}
 
 		return true;
@@ -157,7 +192,65 @@ public:
 		std::swap(head, tail);
 	}
 
-	friend std::ostream& operator<< (std::ostream& os, const list<T>& list)
+	// Stable radix sort by key(element), the element itself by default. Only relinks nodes.
+	template <typename Key = radix_identity>
+	void radix_sort(Key key = Key())
+	{
+		node* last = radix_sort_nodes(head, [](node* n) -> node*& { return n->next; }, [&key](node* n) { return key(n->element); });
+		if (last)
+			tail = last;
+	}
+
+	// Stable merge sort by comp. Only relinks nodes.
+	template <typename Compare = std::less<T>>
+	void sort(Compare comp = Compare())
+	{
+		merge_sort_chain(head, [](node* n) -> node*& { return n->next; }, [&comp](node* a, node* b) { return comp(a->element, b->element); });
+		for (tail = head; tail && tail->next; tail = tail->next);
+	}
+
+	// Merges the sorted list other into this sorted list and leaves other empty. Equal elements
+	// of this list come first. other must use an equal allocator.
+	template <typename Compare = std::less<T>>
+	void merge(list& other, Compare comp = Compare())
+	{
+		if (&other == this || other.empty())
+			return;
+
+		if (!tail || !comp(other.tail->element, tail->element))
+			tail = other.tail;
+		head = merge_chains(head, other.head, [](node* n) -> node*& { return n->next; }, [&comp](node* a, node* b) { return comp(a->element, b->element); });
+		other.head = other.tail = nullptr;
+	}
+
+	// Moves all nodes of other to the front or back of this list in O(1).
+	// other must use an equal allocator.
+	void splice_front(list& other)
+	{
+		if (&other == this || other.empty())
+			return;
+
+		other.tail->next = head;
+		if (!tail)
+			tail = other.tail;
+		head = other.head;
+		other.head = other.tail = nullptr;
+	}
+
+	void splice_back(list& other)
+	{
+		if (&other == this || other.empty())
+			return;
+
+		if (tail)
+			tail->next = other.head;
+		else
+			head = other.head;
+		tail = other.tail;
+		other.head = other.tail = nullptr;
+	}
+
+	friend std::ostream& operator<< (std::ostream& os, const list<T, Allocator>& list)
 	{
 		for (const node *node = list.head; node; node = node->next)
 			os << node->element;
@@ -196,6 +289,45 @@ public:
 	// Begin and end iterators.
 	iterator begin() const { return iterator(head); }
 	iterator end() const { return iterator(tail->next); } // { return iterator(tail); }
+
+	// Moves all nodes of other after pos in O(1). other must use an equal allocator.
+	void splice_after(iterator pos, list& other)
+	{
+		if (&other == this || other.empty())
+			return;
+
+		other.tail->next = pos.pnode->next;
+		pos.pnode->next = other.head;
+		if (tail == pos.pnode)
+			tail = other.tail;
+		other.head = other.tail = nullptr;
+	}
+
+	// Moves the node following it in other after pos in O(1). other may be this list.
+	void splice_after(iterator pos, list& other, iterator it)
+	{
+		node* n = it.pnode->next;
+		if (!n || n == pos.pnode || it.pnode == pos.pnode)
+			return;
+
+		it.pnode->next = n->next;
+		if (other.tail == n)
+			other.tail = it.pnode;
+
+		n->next = pos.pnode->next;
+		pos.pnode->next = n;
+		if (tail == pos.pnode)
+			tail = n;
+	}
 };
 
+#if (__cplusplus >= 201703L)
+namespace pmr
+{
+	// List drawing its nodes from a std::pmr::memory_resource.
+	template <typename T>
+	using list = ::list<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
+
 #endif
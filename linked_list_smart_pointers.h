@@ -4,7 +4,9 @@
 #include <iostream>  // cout
 #include <memory>    // smart T*
 #include <exception> // out_of_range
+#include <functional> // less
 #include <atomic>
+#include "list_sort.h"
 
 template <typename T>
 class list
@@ -12,10 +14,10 @@ class list
 private:
 	struct node
 	{
-		template <typename T> friend class list;
+		friend class list;
 		explicit node(T e) : element(e) { }
 		explicit node(std::shared_ptr<node> n) : next(n) { }
-		node(T e, std:shared_ptr<node> n) : element(e), next(n) { }
+		node(T e, std::shared_ptr<node> n) : element(e), next(n) { }
 		~node() { ~T(); next = nullptr; }
 
 	protected:
@@ -26,6 +28,8 @@ private:
 	std::shared_ptr<node> head = nullptr;
 	std::shared_ptr<node> tail = nullptr;
 
+	static std::shared_ptr<node>& next_of(const std::shared_ptr<node>& n) { return n->next; }
+
 public:
 	// Inner iterator class. Member typedefs provided through inherit from std::iterator.
 	class iterator : public std::iterator<std::forward_iterator_tag, T>
@@ -85,7 +89,7 @@ public:
 
 		const_iterator() : pnode(nullptr) { }
 		const_iterator(std::shared_ptr<node> node) : pnode(node) { }
-		const_iterator(const typename iterator& other) : pnode(other.pnode) { }
+		const_iterator(const iterator& other) : pnode(other.pnode) { }
 		const_iterator(const const_iterator& other) : pnode(other.pnode) { }
 
 		const_iterator& operator ++() 
@@ -388,16 +392,82 @@ public:
 		return os << std::endl;
 	}
 
-	void sort()
+	// Stable merge sort by comp. Only relinks nodes, elements are not copied.
+	template <typename Compare = std::less<T>>
+	void sort(Compare comp = Compare())
+	{
+		merge_sort_chain(head, next_of, [&comp](const std::shared_ptr<node>& a, const std::shared_ptr<node>& b) { return comp(a->element, b->element); });
+		for (tail = head; tail && tail->next; tail = tail->next);
+	}
+
+	// Merges the sorted list other into this sorted list and leaves other empty. Equal elements
+	// of this list come first.
+	template <typename Compare = std::less<T>>
+	void merge(list<T>& other, Compare comp = Compare())
+	{
+		if (&other == this || other.empty())
+			return;
+
+		if (!tail || !comp(other.tail->element, tail->element))
+			tail = other.tail;
+		head = merge_chains(head, other.head, next_of, [&comp](const std::shared_ptr<node>& a, const std::shared_ptr<node>& b) { return comp(a->element, b->element); });
+		other.head = other.tail = nullptr;
+	}
+
+	// Moves all nodes of other after pos, which may be before_begin(), in O(1).
+	void splice_after(iterator pos, list<T>& other)
+	{
+		if (&other == this || other.empty())
+			return;
+
+		if (pos.getNext() == head)
+		{
+			other.tail->next = head;
+			if (!tail)
+				tail = other.tail;
+			head = other.head;
+		}
+		else
+		{
+			other.tail->next = pos.getNext();
+			pos.setNext(other.head);
+			if (pos.pnode == tail)
+				tail = other.tail;
+		}
+		other.head = other.tail = nullptr;
+	}
+
+	// Moves the node following it in other, which may be this list, after pos in O(1).
+	// Both it and pos may be before_begin().
+	void splice_after(iterator pos, list<T>& other, iterator it)
 	{
-		for (auto index1 = head; index1->next; index1 = index1->next)
-			for (auto index2 = index1->next; index2; index2 = index2->next)
-				if (index1->element > index2->element)
-				{
-					auto temp = index1->element;
-					index1->element = index2->element;
-					index2->element = temp;
-				}
+		auto n = it.getNext();
+		if (!n || n == pos.pnode || (&other == this && n == pos.getNext()))
+			return;
+
+		bool front = pos.getNext() == head;
+
+		if (n == other.head)
+			other.head = n->next;
+		else
+			it.setNext(n->next);
+		if (n == other.tail)
+			other.tail = other.head ? it.pnode : nullptr;
+
+		if (front)
+		{
+			n->next = head;
+			head = n;
+			if (!tail)
+				tail = n;
+		}
+		else
+		{
+			n->next = pos.getNext();
+			pos.setNext(n);
+			if (pos.pnode == tail)
+				tail = n;
+		}
 	}
 
 	template <typename BinPred>
@@ -0,0 +1,67 @@
+// Merge and bottom-up merge sort for null-terminated chains of list nodes. Nodes are only
+// relinked, elements never move or get copied. A link is a raw node pointer or a
+// std::shared_ptr to the node; next(link) returns a reference to the node's next link.
+// Both are stable: of two equal elements the one from the first chain comes first.
+#ifndef _LIST_SORT_H_
+#define _LIST_SORT_H_
+
+#include <cstddef> // size_t
+#include <utility> // move
+
+// Merges the sorted chains a and b by less(link, link) and returns the head of the result.
+template <typename Link, typename Next, typename Less>
+Link merge_chains(Link a, Link b, Next next, Less less)
+{
+	Link head{};
+	Link* tail = &head;
+
+	while (a && b)
+	{
+		if (less(b, a))
+		{
+			*tail = std::move(b);
+			b = std::move(next(*tail));
+		}
+		else
+		{
+			*tail = std::move(a);
+			a = std::move(next(*tail));
+		}
+		tail = &next(*tail);
+	}
+	*tail = a ? std::move(a) : std::move(b);
+	return head;
+}
+
+// Sorts the chain starting at head in O(n log n) with O(1) extra space. Runs of 2^i nodes are
+// kept in bin i and merged upwards like a binary counter, so no pass has to find a midpoint.
+template <typename Link, typename Next, typename Less>
+void merge_sort_chain(Link& head, Next next, Less less)
+{
+	Link bins[64]{}; // Bin i holds a sorted run of 2^i nodes, or nothing.
+	std::size_t used = 0;
+
+	while (head)
+	{
+		Link run = std::move(head);
+		head = std::move(next(run));
+		next(run) = Link{};
+
+		std::size_t i = 0;
+		for (; i < used && bins[i]; ++i)
+		{
+			run = merge_chains(std::move(bins[i]), std::move(run), next, less);
+			bins[i] = Link{};
+		}
+		if (i == used)
+			++used;
+		bins[i] = std::move(run);
+	}
+
+	// Higher bins hold earlier nodes.
+	for (std::size_t i = 0; i < used; ++i)
+		if (bins[i])
+			head = merge_chains(std::move(bins[i]), std::move(head), next, less);
+}
+
+#endif
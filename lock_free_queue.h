@@ -1,13 +1,25 @@
 // Multi-producer multi-consumer bounded ring buffer FIFO queue implementation.
 // C++11, adaptation of code found here: https://github.com/craflin/LockFreeQueue
+// With PadSlots each slot is aligned to its own cache line, so producers and consumers working
+// on neighbouring slots do not share lines; worth it for elements up to a few cache lines.
+// wait_pop and wait_push block through the Wait strategy (see wait_strategy.h).
+// Stats = queue_stats records contention and occupancy telemetry, read through stats()
+// (see queue_stats.h); the default no_queue_stats compiles to nothing.
 
 #ifndef _LOCK_FREE_QUEUE_H_
 #define _LOCK_FREE_QUEUE_H_
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "queue_stats.h"
+#include "wait_strategy.h"
 
-template <typename T> 
+template <typename T, bool PadSlots = false, typename Wait = spin_yield_wait, typename Stats = no_queue_stats>
 class thread_safe_queue
 {
 public:
@@ -18,27 +30,31 @@ public:
             _capacityMask |= _capacityMask >> i;
         _capacity = _capacityMask + 1;
 
-        _queue = (Node*)new char[sizeof(Node) * _capacity];
+        _queue = std::allocator<Node>().allocate(_capacity);
         for (size_t i = 0; i < _capacity; ++i)
-        {
-            _queue[i].tail.store(i, std::memory_order_relaxed);
-            _queue[i].head.store(-1, std::memory_order_relaxed);
-        }
+            new (&_queue[i]) Node(i);
 
         _tail.store(0, std::memory_order_relaxed);
         _head.store(0, std::memory_order_relaxed);
     }
 
+    thread_safe_queue(const thread_safe_queue&) = delete;
+    thread_safe_queue& operator= (const thread_safe_queue&) = delete;
+
     ~thread_safe_queue()
     {
         for (size_t i = _head; i != _tail; ++i)
             (&_queue[i & _capacityMask].data)->~T();
+        for (size_t i = 0; i < _capacity; ++i)
+            _queue[i].~Node();
 
-        delete[] (char*)_queue;
+        std::allocator<Node>().deallocate(_queue, _capacity);
     }
 
     size_t capacity() const { return _capacity; }
 
+    const Stats& stats() const { return _stats; }
+
     size_t size() const
     {
         size_t head = _head.load(std::memory_order_acquire);
@@ -47,45 +63,246 @@ public:
 
     bool empty() const { return (size() == 0); }
 
-    bool push(const T& data)
+    bool push(const T& data) { return emplace(data); }
+    bool push(T&& data) { return emplace(std::move(data)); }
+
+    // Constructs the element in its slot; returns false when the queue is full.
+    // A claimed slot must be published, so T is only built in place when that cannot throw.
+    // Otherwise it is built first and moved in, and a false return may leave rvalue arguments
+    // moved from.
+    template <typename... Args>
+    bool emplace(Args&&... args)
     {
-        Node* node;
-        size_t tail = _tail.load(std::memory_order_relaxed);
-        for (;;)
+        if constexpr (std::is_nothrow_constructible<T, Args&&...>::value)
+            return construct(std::forward<Args>(args)...);
+        else
         {
-            node = &_queue[tail & _capacityMask];
-            if (node->tail.load(std::memory_order_relaxed) != tail)
-                return false;
-            if ((_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)))
-                break;
+            static_assert(std::is_nothrow_move_constructible<T>::value, "thread_safe_queue needs a T that is nothrow move constructible");
+            T element(std::forward<Args>(args)...);
+            return construct(std::move(element));
         }
-        new (&node->data)T(data);
-        node->head.store(tail, std::memory_order_release);
-        return true;
     }
 
+    // The move into result must not throw: the slot is already claimed and would never be
+    // released.
     bool pop(T& result)
     {
+        static_assert(std::is_nothrow_move_assignable<T>::value, "thread_safe_queue::pop needs a T that is nothrow move assignable");
         Node* node;
+        _stats.pop_attempt();
         size_t head = _head.load(std::memory_order_relaxed);
         for (;;)
         {
             node = &_queue[head & _capacityMask];
-            if (node->head.load(std::memory_order_relaxed) != head)
+            if (node->head.load(std::memory_order_acquire) != head)
+            {
+                _stats.pop_empty();
                 return false;
+            }
             if (_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
                 break;
+            _stats.cas_retry();
         }
-        result = node->data;
+        _stats.popped(*node);
+        result = std::move(node->data);
         (&node->data)->~T();
         node->tail.store(head + _capacity, std::memory_order_release);
+        _notFull.notify_one();
         return true;
     }
 
+    // Blocking versions: wait through the Wait strategy until the operation succeeds, or until
+    // the timeout expires and return false.
+    bool wait_pop(T& result)
+    {
+        return pop(result) || _notEmpty.wait([&] { return pop(result); }, wait_detail::clock::time_point::max());
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_pop(T& result, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return pop(result) || _notEmpty.wait([&] { return pop(result); }, deadline(timeout));
+    }
+
+    // data is only moved from once a slot has been claimed.
+    template <typename U>
+    bool wait_push(U&& data)
+    {
+        return push_until(std::forward<U>(data), wait_detail::clock::time_point::max());
+    }
+
+    template <typename U, typename Rep, typename Period>
+    bool wait_push(U&& data, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return push_until(std::forward<U>(data), deadline(timeout));
+    }
+
+    // Pushes up to last - first elements (fewer when the queue fills up) and returns how many.
+    // The run of free slots is claimed with a single CAS on _tail, then filled in order. When
+    // constructing T from *first can throw, the elements are pushed one by one through emplace
+    // instead, so a throw never leaves claimed slots behind.
+    template <typename ForwardIt>
+    size_t push_bulk(ForwardIt first, ForwardIt last)
+    {
+        static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>::value,
+            "push_bulk walks the range twice and needs forward iterators");
+
+        size_t wanted = static_cast<size_t>(std::distance(first, last));
+        if (wanted == 0)
+            return 0;
+        if constexpr (!std::is_nothrow_constructible<T, typename std::iterator_traits<ForwardIt>::reference>::value)
+        {
+            size_t n = 0;
+            for (; n < wanted && emplace(*first); ++n, ++first);
+            return n;
+        }
+
+        _stats.push_attempt();
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t n;
+        for (;;)
+        {
+            n = 0;
+            while (n < wanted && _queue[(tail + n) & _capacityMask].tail.load(std::memory_order_acquire) == tail + n)
+                ++n;
+            if (n == 0)
+            {
+                _stats.push_full();
+                return 0;
+            }
+            if (_tail.compare_exchange_weak(tail, tail + n, std::memory_order_relaxed))
+                break;
+            _stats.cas_retry();
+        }
+        for (size_t i = 0; i < n; ++i, ++first)
+        {
+            Node& node = _queue[(tail + i) & _capacityMask];
+            new (&node.data)T(*first);
+            _stats.pushed(node, tail + i, _head);
+            node.head.store(tail + i, std::memory_order_release);
+        }
+        _notEmpty.notify();
+        return n;
+    }
+
+    // Pops up to max elements into out and returns how many. The run of filled slots is claimed
+    // with a single CAS on _head, then drained in order. If writing to out throws, the claimed
+    // elements not yet written are destroyed and their slots released before the exception
+    // propagates.
+    template <typename OutputIt>
+    size_t pop_bulk(OutputIt out, size_t max)
+    {
+        if (max == 0)
+            return 0;
+        _stats.pop_attempt();
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t n;
+        for (;;)
+        {
+            n = 0;
+            while (n < max && _queue[(head + n) & _capacityMask].head.load(std::memory_order_acquire) == head + n)
+                ++n;
+            if (n == 0)
+            {
+                _stats.pop_empty();
+                return 0;
+            }
+            if (_head.compare_exchange_weak(head, head + n, std::memory_order_relaxed))
+                break;
+            _stats.cas_retry();
+        }
+        ReleaseGuard guard{ *this, head, 0, n };
+        for (; guard.next < n; ++out)
+        {
+            Node& node = _queue[(head + guard.next) & _capacityMask];
+            _stats.popped(node);
+            *out = std::move(node.data);
+            release(head + guard.next++);
+        }
+        return n;
+    }
+
 private:
-    struct Node
+    // Destroys the element at ticket position head and hands its slot back to the producers.
+    void release(size_t head)
+    {
+        Node& node = _queue[head & _capacityMask];
+        (&node.data)->~T();
+        node.tail.store(head + _capacity, std::memory_order_release);
+    }
+
+    // Releases the slots [head + next, head + count) claimed by pop_bulk, then wakes producers.
+    struct ReleaseGuard
+    {
+        thread_safe_queue& queue;
+        size_t head;
+        size_t next;
+        size_t count;
+
+        ~ReleaseGuard()
+        {
+            for (; next < count; ++next)
+                queue.release(head + next);
+            queue._notFull.notify();
+        }
+    };
+
+    // Claims a slot and constructs the element there; the construction must not throw.
+    template <typename... Args>
+    bool construct(Args&&... args)
+    {
+        Node* node;
+        _stats.push_attempt();
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            node = &_queue[tail & _capacityMask];
+            if (node->tail.load(std::memory_order_acquire) != tail)
+            {
+                _stats.push_full();
+                return false;
+            }
+            if ((_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)))
+                break;
+            _stats.cas_retry();
+        }
+        new (&node->data)T(std::forward<Args>(args)...);
+        _stats.pushed(*node, tail, _head);
+        node->head.store(tail, std::memory_order_release);
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    template <typename U>
+    bool push_until(U&& data, wait_detail::clock::time_point until)
     {
-        T data;
+        if constexpr (std::is_nothrow_constructible<T, U&&>::value)
+            return construct(std::forward<U>(data)) || _notFull.wait([&] { return construct(std::forward<U>(data)); }, until);
+        else
+        {
+            static_assert(std::is_nothrow_move_constructible<T>::value, "thread_safe_queue needs a T that is nothrow move constructible");
+            T element(std::forward<U>(data));
+            return push_until(std::move(element), until);
+        }
+    }
+
+    template <typename Rep, typename Period>
+    static wait_detail::clock::time_point deadline(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return wait_detail::clock::now() + std::chrono::duration_cast<wait_detail::clock::duration>(timeout);
+    }
+
+    static constexpr size_t naturalAlign = alignof(T) > alignof(std::atomic<size_t>) ? alignof(T) : alignof(std::atomic<size_t>);
+    static constexpr size_t slotAlign = PadSlots && naturalAlign < 64 ? 64 : naturalAlign;
+
+    // data is constructed by push and destroyed by pop only. The Stats stamp (empty unless
+    // telemetry is on) records when the element was pushed.
+    struct alignas(slotAlign) Node : Stats::stamp
+    {
+        explicit Node(size_t i) : tail(i), head(size_t(-1)) { }
+        ~Node() { }
+
+        union { T data; };
         std::atomic<size_t> tail;
         std::atomic<size_t> head;
     };
@@ -99,6 +316,11 @@ private:
     char cacheLinePad2[64];
     std::atomic<size_t> _head;
     char cacheLinePad3[64];
+    Wait _notEmpty; // Consumers waiting for an element.
+    char cacheLinePad4[64];
+    Wait _notFull;  // Producers waiting for a free slot.
+    char cacheLinePad5[64];
+    Stats _stats;
 };
 
 #endif
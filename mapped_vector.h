@@ -0,0 +1,342 @@
+// File-backed vector of trivially copyable elements. The file is a small header (magic,
+// version, element size, count) followed by the raw elements and is mapped shared, so opening
+// an existing file copies nothing and every change lands in the file. POSIX only.
+// Files are native-endian and only portable between machines with the same layout of T.
+#ifndef _MAPPED_VECTOR_H_
+#define _MAPPED_VECTOR_H_
+
+#include <algorithm>    // equal
+#include <cstddef>      // size_t
+#include <cstdint>      // uint32_t, uint64_t
+#include <cstring>      // memcmp, memcpy
+#include <cerrno>       // errno
+#include <iterator>     // reverse_iterator
+#include <memory>       // uninitialized_fill
+#include <stdexcept>    // runtime_error, out_of_range
+#include <system_error> // system_error
+#include <type_traits>  // is_trivially_copyable
+#include <utility>      // swap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <typename T>
+class mapped_vector
+{
+	static_assert(std::is_trivially_copyable<T>::value, "mapped_vector<>: T must be trivially copyable");
+	static_assert(alignof(T) <= 64, "mapped_vector<>: T must not be over-aligned");
+
+	// Elements start at offset 64, which keeps them aligned for any T allowed above.
+	struct header
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t elementSize;
+		std::uint64_t count;
+		std::uint64_t capacity;
+		char reserved[32];
+	};
+	static_assert(sizeof(header) == 64, "mapped_vector<>: unexpected header size");
+
+	static constexpr char magic_bytes[8] = { 'M', 'A', 'P', 'V', 'E', 'C', 0, 0 };
+	static constexpr std::uint32_t file_version = 1;
+
+	int fd;             // Backing file, -1 when closed.
+	header* head;       // Start of the mapping.
+	std::size_t mapped; // Mapping size in bytes.
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = T * ;
+	using const_iterator = const T*;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	iterator begin() noexcept { return data(); }
+	iterator end() noexcept { return data() + size(); }
+	const_iterator begin() const noexcept { return data(); }
+	const_iterator end() const noexcept { return data() + size(); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	mapped_vector() noexcept : fd(-1), head(nullptr), mapped(0) { }
+
+	// Opens path, creating an empty vector if the file does not exist.
+	explicit mapped_vector(const char* path) : mapped_vector() { open(path); }
+
+	mapped_vector(const mapped_vector&) = delete;
+	mapped_vector& operator= (const mapped_vector&) = delete;
+
+	mapped_vector(mapped_vector&& rhs) noexcept : mapped_vector() { swap(rhs); }
+
+	mapped_vector& operator= (mapped_vector&& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			close();
+			swap(rhs);
+		}
+		return *this;
+	}
+
+	~mapped_vector() { close(); }
+
+	// Maps an existing file, or creates one. Throws std::system_error on I/O failure and
+	// std::runtime_error if the file is not a mapped_vector of this element size.
+	void open(const char* path)
+	{
+		close();
+
+		fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (fd < 0)
+			throw_errno("mapped_vector: open");
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
+			fail_errno("mapped_vector: fstat");
+
+		if (st.st_size == 0)
+		{
+			header h = {};
+			std::memcpy(h.magic, magic_bytes, sizeof(h.magic));
+			h.version = file_version;
+			h.elementSize = sizeof(T);
+			if (::pwrite(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)))
+				fail_errno("mapped_vector: write");
+			st.st_size = sizeof(h);
+		}
+		else if (static_cast<std::size_t>(st.st_size) < sizeof(header))
+			fail("mapped_vector: file too small");
+
+		map(static_cast<std::size_t>(st.st_size));
+
+		if (std::memcmp(head->magic, magic_bytes, sizeof(head->magic)) != 0)
+			fail("mapped_vector: not a mapped_vector file");
+		if (head->version != file_version)
+			fail("mapped_vector: unsupported version");
+		if (head->elementSize != sizeof(T))
+			fail("mapped_vector: element size mismatch");
+		if (head->capacity > (mapped - sizeof(header)) / sizeof(T) || head->count > head->capacity)
+			fail("mapped_vector: truncated file");
+	}
+
+	// Trims unused capacity from the file and unmaps it.
+	void close() noexcept
+	{
+		if (fd < 0)
+			return;
+		if (head)
+		{
+			std::size_t bytes = sizeof(header) + head->count * sizeof(T);
+			head->capacity = head->count;
+			::munmap(head, mapped);
+			int r = ::ftruncate(fd, static_cast<off_t>(bytes));
+			(void)r; // A failed trim only leaves spare capacity in the file.
+		}
+		::close(fd);
+		fd = -1;
+		head = nullptr;
+		mapped = 0;
+	}
+
+	bool is_open() const noexcept { return head != nullptr; }
+
+	// Writes dirty pages back to the file and waits for completion.
+	void flush()
+	{
+		if (head && ::msync(head, mapped, MS_SYNC) != 0)
+			throw_errno("mapped_vector: msync");
+	}
+
+	void clear() noexcept
+	{
+		if (head)
+			head->count = 0;
+	}
+
+	void push_back(const T& d)
+	{
+		if (size() == capacity())
+		{
+			T temp(d); // d may refer to an element of this vector.
+			grow(next_capacity());
+			data()[head->count++] = temp;
+		}
+		else
+			data()[head->count++] = d;
+	}
+
+	template<typename ...Args>
+	T& emplace_back(Args&&... args)
+	{
+		T temp(std::forward<Args>(args)...);
+		push_back(temp);
+		return back();
+	}
+
+	void pop_back()
+	{
+		if (size() == 0)
+			return;
+		head->count--;
+	}
+
+	const T& operator[] (std::size_t i) const { return data()[i]; }
+	T& operator[] (std::size_t i) { return data()[i]; }
+
+	const T& at(std::size_t i) const
+	{
+		if (i >= size())
+			throw std::out_of_range("mapped_vector: index out of range");
+		return data()[i];
+	}
+
+	T& at(std::size_t i)
+	{
+		if (i >= size())
+			throw std::out_of_range("mapped_vector: index out of range");
+		return data()[i];
+	}
+
+	T* data() noexcept { return head ? reinterpret_cast<T*>(head + 1) : nullptr; }
+	const T* data() const noexcept { return head ? reinterpret_cast<const T*>(head + 1) : nullptr; }
+
+	T& front() { return data()[0]; }
+	T& back() { return data()[size() - 1]; }
+	const T& front() const { return data()[0]; }
+	const T& back() const { return data()[size() - 1]; }
+
+	std::size_t size() const noexcept { return head ? static_cast<std::size_t>(head->count) : 0; }
+	bool empty() const noexcept { return size() == 0; }
+	std::size_t max_size() const noexcept { return (std::size_t(-1) - sizeof(header)) / sizeof(T); }
+	std::size_t capacity() const noexcept { return head ? static_cast<std::size_t>(head->capacity) : 0; }
+
+	// Grows the file to hold at least n elements, never shrinks.
+	void reserve(std::size_t n)
+	{
+		if (n > capacity())
+			grow(n);
+	}
+
+	// New elements are value-initialized.
+	void resize(std::size_t n) { resize(n, T()); }
+
+	void resize(std::size_t n, const T& d)
+	{
+		if (n > capacity())
+		{
+			T temp(d);
+			grow(n);
+			std::uninitialized_fill(data() + size(), data() + n, temp);
+		}
+		else if (n > size())
+			std::uninitialized_fill(data() + size(), data() + n, d);
+		head->count = n;
+	}
+
+	// Truncates the file to the elements in use.
+	void shrink_to_fit()
+	{
+		if (size() < capacity())
+			remap(size());
+	}
+
+	void swap(mapped_vector& rhs) noexcept
+	{
+		std::swap(fd, rhs.fd);
+		std::swap(head, rhs.head);
+		std::swap(mapped, rhs.mapped);
+	}
+
+private:
+	// Doubles the old space.
+	std::size_t next_capacity() const noexcept { return capacity() ? capacity() * 2 : 1; }
+
+	void grow(std::size_t n)
+	{
+		if (n > max_size())
+			throw std::length_error("mapped_vector: too many elements");
+		remap(n);
+	}
+
+	// Resizes the file to n elements of capacity and maps it again.
+	void remap(std::size_t n)
+	{
+		std::size_t bytes = sizeof(header) + n * sizeof(T);
+
+		if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+			throw_errno("mapped_vector: ftruncate");
+
+#if defined(__linux__)
+		void* p = ::mremap(head, mapped, bytes, MREMAP_MAYMOVE);
+		if (p == MAP_FAILED)
+			throw_errno("mapped_vector: mremap");
+		head = static_cast<header*>(p);
+		mapped = bytes;
+#else
+		::munmap(head, mapped);
+		head = nullptr;
+		map(bytes);
+#endif
+		head->capacity = n;
+	}
+
+	void map(std::size_t bytes)
+	{
+		void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED)
+			fail_errno("mapped_vector: mmap");
+		head = static_cast<header*>(p);
+		mapped = bytes;
+	}
+
+	// Error paths of open(): the file is left untouched.
+	[[noreturn]] void fail(const char* what)
+	{
+		discard();
+		throw std::runtime_error(what);
+	}
+
+	[[noreturn]] void fail_errno(const char* what)
+	{
+		int e = errno;
+		discard();
+		throw std::system_error(e, std::generic_category(), what);
+	}
+
+	[[noreturn]] static void throw_errno(const char* what)
+	{
+		throw std::system_error(errno, std::generic_category(), what);
+	}
+
+	void discard() noexcept
+	{
+		if (head)
+			::munmap(head, mapped);
+		::close(fd);
+		fd = -1;
+		head = nullptr;
+		mapped = 0;
+	}
+};
+
+template <typename T>
+bool operator== (const mapped_vector<T>& lhs, const mapped_vector<T>& rhs)
+{
+	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T>
+bool operator!= (const mapped_vector<T>& lhs, const mapped_vector<T>& rhs) { return !(lhs == rhs); }
+
+template <typename T>
+void swap(mapped_vector<T>& lhs, mapped_vector<T>& rhs) noexcept { lhs.swap(rhs); }
+
+#endif
@@ -0,0 +1,337 @@
+// Fixed-size multi-dimensional array stored in a cache-line aligned array<T, N>. The layout maps
+// a multi-index to a storage offset: row-major (default), column-major, square tiles, or Morton
+// (Z) order, the last two keeping 2-D neighbourhoods on few cache lines. Rank-2 arrays offer row,
+// column and sub-block views that index through the layout.
+#ifndef _MDARRAY_H_
+#define _MDARRAY_H_
+
+#include <cstddef>     // size_t, ptrdiff_t
+#include <cstdint>     // uint64_t
+#include <iterator>    // random_access_iterator_tag
+#include <stdexcept>   // out_of_range
+#include <type_traits> // remove_const
+#include "array.h"
+
+// Storage alignment of every mdarray, one cache line.
+constexpr std::size_t mdarray_alignment = 64;
+
+// Last index varies fastest.
+struct layout_row_major
+{
+	template <std::size_t... Dims>
+	struct mapping
+	{
+		static constexpr std::size_t rank = sizeof...(Dims);
+		static constexpr std::size_t size = (Dims * ...);
+
+		static constexpr std::size_t index(const std::size_t (&i)[rank]) noexcept
+		{
+			constexpr std::size_t d[] = { Dims... };
+			std::size_t r = 0;
+			for (std::size_t k = 0; k < rank; ++k)
+				r = r * d[k] + i[k];
+			return r;
+		}
+	};
+};
+
+// First index varies fastest.
+struct layout_column_major
+{
+	template <std::size_t... Dims>
+	struct mapping
+	{
+		static constexpr std::size_t rank = sizeof...(Dims);
+		static constexpr std::size_t size = (Dims * ...);
+
+		static constexpr std::size_t index(const std::size_t (&i)[rank]) noexcept
+		{
+			constexpr std::size_t d[] = { Dims... };
+			std::size_t r = 0;
+			for (std::size_t k = rank; k-- > 0; )
+				r = r * d[k] + i[k];
+			return r;
+		}
+	};
+};
+
+// Rank 2 only. Tile x Tile blocks stored one after another in row-major order, row-major inside
+// a block. Extents are padded up to whole tiles.
+template <std::size_t Tile = 8>
+struct layout_tiled
+{
+	static_assert(Tile > 0, "layout_tiled<>: tile size must be non-zero");
+
+	template <std::size_t... Dims>
+	struct mapping
+	{
+		static_assert(sizeof...(Dims) == 2, "layout_tiled<>: rank must be 2");
+
+		static constexpr std::size_t rank = 2;
+		static constexpr std::size_t d[] = { Dims... };
+		static constexpr std::size_t tileCols = (d[1] + Tile - 1) / Tile;
+		static constexpr std::size_t size = (d[0] + Tile - 1) / Tile * tileCols * Tile * Tile;
+
+		static constexpr std::size_t index(const std::size_t (&i)[2]) noexcept
+		{
+			return ((i[0] / Tile) * tileCols + i[1] / Tile) * (Tile * Tile) + (i[0] % Tile) * Tile + i[1] % Tile;
+		}
+	};
+};
+
+// Rank 2 only. Z-order curve: row and column bits interleaved, column bit lowest. Both extents
+// are padded up to the same power of two, so square power-of-two shapes waste nothing.
+struct layout_morton
+{
+	template <std::size_t... Dims>
+	struct mapping
+	{
+		static_assert(sizeof...(Dims) == 2, "layout_morton: rank must be 2");
+
+		static constexpr std::size_t rank = 2;
+		static constexpr std::size_t side = []
+		{
+			constexpr std::size_t d[] = { Dims... };
+			std::size_t s = 1;
+			while (s < d[0] || s < d[1])
+				s *= 2;
+			return s;
+		}();
+		static constexpr std::size_t size = side * side;
+
+		// Moves bit k of x to bit 2k.
+		static constexpr std::uint64_t spread(std::uint64_t x) noexcept
+		{
+			x &= 0xFFFFFFFFull;
+			x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+			x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+			x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+			x = (x | (x << 2)) & 0x3333333333333333ull;
+			x = (x | (x << 1)) & 0x5555555555555555ull;
+			return x;
+		}
+
+		static constexpr std::size_t index(const std::size_t (&i)[2]) noexcept
+		{
+			return std::size_t((spread(i[0]) << 1) | spread(i[1]));
+		}
+	};
+};
+
+// One row (Column = false) or column of a rank-2 array or block. Indexes through Map.
+template <typename T, typename Map, bool Column>
+class md_lane
+{
+	T* base;
+	std::size_t r0, c0, n;
+
+	constexpr std::size_t offset(std::size_t k) const noexcept
+	{
+		const std::size_t i[2] = { Column ? r0 + k : r0, Column ? c0 : c0 + k };
+		return Map::index(i);
+	}
+
+public:
+	class iterator
+	{
+		md_lane lane;
+		std::size_t k;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = typename std::remove_const<T>::type;
+		using difference_type = std::ptrdiff_t;
+		using reference = T&;
+		using pointer = T*;
+
+		constexpr iterator() noexcept : lane(nullptr, 0, 0, 0), k(0) { }
+		constexpr iterator(const md_lane& l, std::size_t n) noexcept : lane(l), k(n) { }
+
+		constexpr reference operator* () const { return lane[k]; }
+		constexpr pointer operator-> () const { return &lane[k]; }
+		constexpr reference operator[] (difference_type n) const { return lane[k + n]; }
+
+		constexpr iterator& operator++ () { ++k; return *this; }
+		constexpr iterator operator++ (int) { iterator t(*this); ++k; return t; }
+		constexpr iterator& operator-- () { --k; return *this; }
+		constexpr iterator operator-- (int) { iterator t(*this); --k; return t; }
+		constexpr iterator& operator+= (difference_type n) { k += n; return *this; }
+		constexpr iterator& operator-= (difference_type n) { k -= n; return *this; }
+		constexpr iterator operator+ (difference_type n) const { return iterator(lane, k + n); }
+		constexpr iterator operator- (difference_type n) const { return iterator(lane, k - n); }
+		friend constexpr iterator operator+ (difference_type n, const iterator& it) { return it + n; }
+		constexpr difference_type operator- (const iterator& rhs) const { return difference_type(k) - difference_type(rhs.k); }
+
+		constexpr bool operator== (const iterator& rhs) const { return k == rhs.k; }
+		constexpr bool operator!= (const iterator& rhs) const { return k != rhs.k; }
+		constexpr bool operator< (const iterator& rhs) const { return k < rhs.k; }
+		constexpr bool operator> (const iterator& rhs) const { return k > rhs.k; }
+		constexpr bool operator<= (const iterator& rhs) const { return k <= rhs.k; }
+		constexpr bool operator>= (const iterator& rhs) const { return k >= rhs.k; }
+	};
+
+	constexpr md_lane(T* base, std::size_t r, std::size_t c, std::size_t n) noexcept : base(base), r0(r), c0(c), n(n) { }
+
+	constexpr T& operator[] (std::size_t k) const { return base[offset(k)]; }
+
+	constexpr std::size_t size() const noexcept { return n; }
+	// Storage distance between neighbours; constant for row- and column-major layouts only.
+	constexpr std::ptrdiff_t stride() const noexcept { return n > 1 ? std::ptrdiff_t(offset(1)) - std::ptrdiff_t(offset(0)) : 1; }
+
+	constexpr iterator begin() const noexcept { return iterator(*this, 0); }
+	constexpr iterator end() const noexcept { return iterator(*this, n); }
+
+	constexpr void fill(const T& value) const
+	{
+		for (std::size_t k = 0; k < n; ++k)
+			base[offset(k)] = value;
+	}
+};
+
+// Rectangular window [r, r + rows) x [c, c + cols) of a rank-2 array. Indexes through Map.
+template <typename T, typename Map>
+class md_block
+{
+	T* base;
+	std::size_t r0, c0, h, w;
+
+public:
+	using row_type = md_lane<T, Map, false>;
+	using column_type = md_lane<T, Map, true>;
+
+	constexpr md_block(T* base, std::size_t r, std::size_t c, std::size_t rows, std::size_t cols) noexcept
+		: base(base), r0(r), c0(c), h(rows), w(cols) { }
+
+	constexpr T& operator() (std::size_t i, std::size_t j) const
+	{
+		const std::size_t k[2] = { r0 + i, c0 + j };
+		return base[Map::index(k)];
+	}
+
+	constexpr std::size_t rows() const noexcept { return h; }
+	constexpr std::size_t cols() const noexcept { return w; }
+
+	constexpr row_type row(std::size_t i) const noexcept { return row_type(base, r0 + i, c0, w); }
+	constexpr column_type col(std::size_t j) const noexcept { return column_type(base, r0, c0 + j, h); }
+	constexpr md_block block(std::size_t r, std::size_t c, std::size_t rows, std::size_t cols) const noexcept
+	{
+		return md_block(base, r0 + r, c0 + c, rows, cols);
+	}
+
+	constexpr void fill(const T& value) const
+	{
+		for (std::size_t i = 0; i < h; ++i)
+			for (std::size_t j = 0; j < w; ++j)
+				(*this)(i, j) = value;
+	}
+};
+
+template <typename T, typename Layout, std::size_t... Dims>
+struct basic_mdarray
+{
+	static_assert(sizeof...(Dims) > 0 && ((Dims > 0) && ...), "basic_mdarray<>: extents must be non-zero");
+
+	using value_type = T;
+	using layout_type = Layout;
+	using mapping = typename Layout::template mapping<Dims...>;
+
+	// Storage, padded for tiled and Morton layouts; padding is never addressed by a multi-index.
+	alignas(alignof(T) > mdarray_alignment ? alignof(T) : mdarray_alignment) array<T, mapping::size> elements;
+
+	static constexpr std::size_t rank() noexcept { return sizeof...(Dims); }
+	static constexpr std::size_t extent(std::size_t k) noexcept
+	{
+		constexpr std::size_t d[] = { Dims... };
+		return d[k];
+	}
+	// Number of addressable elements.
+	static constexpr std::size_t size() noexcept { return (Dims * ...); }
+	// Number of stored elements, padding included.
+	static constexpr std::size_t storage_size() noexcept { return mapping::size; }
+
+	// Storage offset of a multi-index.
+	template <typename... Index>
+	static constexpr std::size_t offset(Index... idx) noexcept
+	{
+		static_assert(sizeof...(Index) == sizeof...(Dims), "basic_mdarray<>: wrong number of indices");
+		const std::size_t i[] = { std::size_t(idx)... };
+		return mapping::index(i);
+	}
+
+	template <typename... Index>
+	constexpr T& operator() (Index... idx) { return elements[offset(idx...)]; }
+	template <typename... Index>
+	constexpr const T& operator() (Index... idx) const { return elements[offset(idx...)]; }
+
+	// At performs a range check on every index.
+	template <typename... Index>
+	constexpr T& at(Index... idx)
+	{
+		check(idx...);
+		return elements[offset(idx...)];
+	}
+
+	template <typename... Index>
+	constexpr const T& at(Index... idx) const
+	{
+		check(idx...);
+		return elements[offset(idx...)];
+	}
+
+	constexpr T* data() noexcept { return elements.data(); }
+	constexpr const T* data() const noexcept { return elements.data(); }
+
+	// Storage order iteration, padding included.
+	constexpr T* begin() noexcept { return elements.begin(); }
+	constexpr T* end() noexcept { return elements.end(); }
+	constexpr const T* begin() const noexcept { return elements.begin(); }
+	constexpr const T* end() const noexcept { return elements.end(); }
+
+	constexpr void fill(const T& value) { elements.fill(value); }
+
+	// Rank-2 views.
+	using row_type = md_lane<T, mapping, false>;
+	using const_row_type = md_lane<const T, mapping, false>;
+	using column_type = md_lane<T, mapping, true>;
+	using const_column_type = md_lane<const T, mapping, true>;
+	using block_type = md_block<T, mapping>;
+	using const_block_type = md_block<const T, mapping>;
+
+	constexpr row_type row(std::size_t i) noexcept { return row_type(rank2(data()), i, 0, extent(1)); }
+	constexpr const_row_type row(std::size_t i) const noexcept { return const_row_type(rank2(data()), i, 0, extent(1)); }
+	constexpr column_type col(std::size_t j) noexcept { return column_type(rank2(data()), 0, j, extent(0)); }
+	constexpr const_column_type col(std::size_t j) const noexcept { return const_column_type(rank2(data()), 0, j, extent(0)); }
+
+	constexpr block_type block(std::size_t r, std::size_t c, std::size_t rows, std::size_t cols) noexcept
+	{
+		return block_type(rank2(data()), r, c, rows, cols);
+	}
+
+	constexpr const_block_type block(std::size_t r, std::size_t c, std::size_t rows, std::size_t cols) const noexcept
+	{
+		return const_block_type(rank2(data()), r, c, rows, cols);
+	}
+
+private:
+	template <typename P>
+	static constexpr P rank2(P p) noexcept
+	{
+		static_assert(sizeof...(Dims) == 2, "basic_mdarray<>: views need rank 2");
+		return p;
+	}
+
+	template <typename... Index>
+	static constexpr void check(Index... idx)
+	{
+		const std::size_t i[] = { std::size_t(idx)... };
+		for (std::size_t k = 0; k < sizeof...(Dims); ++k)
+			if (i[k] >= extent(k))
+				throw std::out_of_range("basic_mdarray<>: index out of range");
+	}
+};
+
+// Row-major mdarray<T, Rows, Cols, ...>; use basic_mdarray for the other layouts.
+template <typename T, std::size_t... Dims>
+using mdarray = basic_mdarray<T, layout_row_major, Dims...>;
+
+#endif
@@ -1,30 +1,71 @@
 // Min heap. Requires that type T has a function operator< defined.
 #include <memory>
 #include <algorithm>
+#if (__cplusplus >= 201703L)
+#include <memory_resource> // polymorphic_allocator
+#endif
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class min_heap 
 {
-	std::unique_ptr<T[]> data;
+	using alloc_traits = std::allocator_traits<Allocator>;
+
+	Allocator alloc;
+	T* data;
 	std::size_t arrayUsed, arraySize;
 	static constexpr std::size_t INITIAL_SIZE = 2;
 
-	void resize(std::size_t newSize)
+	// Array of n default constructed elements drawn from alloc.
+	T* create(std::size_t n)
+	{
+		T* p = alloc_traits::allocate(alloc, n);
+		std::size_t i = 0;
+		try
+		{
+			for (; i < n; i++)
+				alloc_traits::construct(alloc, p + i);
+		}
+		catch (...)
+		{
+			destroy(p, i);
+			alloc_traits::deallocate(alloc, p, n);
+			throw;
+		}
+		return p;
+	}
+
+	void destroy(T* p, std::size_t n)
 	{
-		std::unique_ptr<T[]> temp = std::make_unique<T[]>(sizeof(T)*arraySize);
-		std::copy(data.get(), data.get() + arraySize, temp.get());
+		for (std::size_t i = 0; i < n; i++)
+			alloc_traits::destroy(alloc, p + i);
+	}
 
-		data.reset(new T[newSize]);
+	void resize(std::size_t newSize)
+	{
+		T* temp = create(newSize);
 
-		std::copy(temp.get(), temp.get() + std::min(arraySize, newSize), data.get());
+		std::move(data, data + std::min(arraySize, newSize), temp);
 
-		temp.reset();
+		destroy(data, arraySize);
+		alloc_traits::deallocate(alloc, data, arraySize);
+		data = temp;
 		arraySize = newSize;
 	}
 
 public:
-	min_heap() : arrayUsed(0), arraySize(INITIAL_SIZE) { data.reset(new T[INITIAL_SIZE]); }
-	~min_heap() { data.reset(); }
+	using allocator_type = Allocator;
+
+	min_heap() : min_heap(Allocator()) { }
+	explicit min_heap(const Allocator& a) : alloc(a), arrayUsed(0), arraySize(INITIAL_SIZE) { data = create(INITIAL_SIZE); }
+	min_heap(const min_heap&) = delete;
+	min_heap& operator= (const min_heap&) = delete;
+	~min_heap()
+	{
+		destroy(data, arraySize);
+		alloc_traits::deallocate(alloc, data, arraySize);
+	}
+
+	allocator_type get_allocator() const { return alloc; }
 	
 	void push(const T& element) 
 	{
@@ -97,3 +138,12 @@ public:
 	bool empty() { return arrayUsed == 0; }
 };
 
+#if (__cplusplus >= 201703L)
+namespace pmr
+{
+	// Min heap drawing its array from a std::pmr::memory_resource.
+	template <typename T>
+	using min_heap = ::min_heap<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
+
@@ -0,0 +1,476 @@
+// Compact unsigned integer vectors.
+// packed_vector<Bits> stores each value in exactly Bits bits with O(1) get and set.
+// compressed_sorted_vector stores a non-decreasing sequence in blocks of 128 values using
+// frame-of-reference encoding: each block keeps its first value and packs the offsets from it
+// at the smallest width that fits. A skip index over the blocks gives O(1) random access and
+// binary search. Both keep their words in a vector<uint64_t> and decode with straight-line
+// shift/mask loops.
+#ifndef _PACKED_VECTOR_H_
+#define _PACKED_VECTOR_H_
+
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <iterator>  // random_access_iterator_tag, reverse_iterator
+#include <stdexcept> // out_of_range
+#include "vector.h"
+
+namespace packed_bits
+{
+	inline constexpr std::uint64_t mask(unsigned bits) { return bits >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1; }
+
+	// Number of bits needed to represent v.
+	inline unsigned width(std::uint64_t v)
+	{
+		unsigned n = 0;
+		for (; v; v >>= 1)
+			++n;
+		return n;
+	}
+
+	// Value of the given width starting at bit pos of words.
+	inline std::uint64_t get(const std::uint64_t* words, std::size_t pos, unsigned bits)
+	{
+		std::size_t w = pos >> 6;
+		unsigned off = pos & 63;
+		std::uint64_t v = words[w] >> off;
+		if (off + bits > 64)
+			v |= words[w + 1] << (64 - off);
+		return v & mask(bits);
+	}
+
+	inline void set(std::uint64_t* words, std::size_t pos, unsigned bits, std::uint64_t v)
+	{
+		std::size_t w = pos >> 6;
+		unsigned off = pos & 63;
+		v &= mask(bits);
+		words[w] = (words[w] & ~(mask(bits) << off)) | (v << off);
+		if (off + bits > 64)
+			words[w + 1] = (words[w + 1] & ~(mask(bits) >> (64 - off))) | (v >> (64 - off));
+	}
+
+	// Decodes n values starting at value index first, adding base to each.
+	inline void unpack(const std::uint64_t* words, std::size_t first, std::size_t n, unsigned bits, std::uint64_t base, std::uint64_t* out)
+	{
+		if (bits == 0)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+				out[i] = base;
+			return;
+		}
+		std::size_t pos = first * bits;
+		for (std::size_t i = 0; i < n; ++i, pos += bits)
+			out[i] = base + get(words, pos, bits);
+	}
+
+	// Words needed for n values of the given width.
+	inline constexpr std::size_t words_for(std::size_t n, unsigned bits) { return (n * bits + 63) / 64; }
+}
+
+template <unsigned Bits>
+class packed_vector
+{
+	static_assert(Bits > 0 && Bits <= 64, "packed_vector<>: width must be 1..64 bits");
+
+	vector<std::uint64_t> words; // Packed values, bit i*Bits onwards holds value i.
+	std::size_t count;           // Number of stored values.
+
+	// Proxy returned by the non-const [] and iterator.
+	class reference
+	{
+		packed_vector* v;
+		std::size_t i;
+
+	public:
+		reference(packed_vector* p, std::size_t n) noexcept : v(p), i(n) { }
+		operator std::uint64_t() const { return v->get(i); }
+		reference& operator= (std::uint64_t x) { v->set(i, x); return *this; }
+		reference& operator= (const reference& rhs) { return *this = std::uint64_t(rhs); }
+
+		friend void swap(reference a, reference b)
+		{
+			std::uint64_t t = a;
+			a = std::uint64_t(b);
+			b = t;
+		}
+	};
+
+	template <bool Const>
+	class packed_iterator
+	{
+		using owner = typename std::conditional<Const, const packed_vector, packed_vector>::type;
+
+		owner* v;
+		std::size_t i;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::uint64_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = typename std::conditional<Const, std::uint64_t, typename packed_vector::reference>::type;
+		using pointer = void;
+
+		packed_iterator() noexcept : v(nullptr), i(0) { }
+		packed_iterator(owner* o, std::size_t n) noexcept : v(o), i(n) { }
+		template <bool C, typename = typename std::enable_if<Const && !C>::type>
+		packed_iterator(const packed_iterator<C>& rhs) noexcept : v(rhs.v), i(rhs.i) { }
+
+		reference operator* () const { return (*v)[i]; }
+		reference operator[] (difference_type n) const { return (*v)[i + n]; }
+
+		packed_iterator& operator++ () { ++i; return *this; }
+		packed_iterator operator++ (int) { packed_iterator t(*this); ++i; return t; }
+		packed_iterator& operator-- () { --i; return *this; }
+		packed_iterator operator-- (int) { packed_iterator t(*this); --i; return t; }
+		packed_iterator& operator+= (difference_type n) { i += n; return *this; }
+		packed_iterator& operator-= (difference_type n) { i -= n; return *this; }
+		packed_iterator operator+ (difference_type n) const { return packed_iterator(v, i + n); }
+		packed_iterator operator- (difference_type n) const { return packed_iterator(v, i - n); }
+		friend packed_iterator operator+ (difference_type n, const packed_iterator& it) { return it + n; }
+		difference_type operator- (const packed_iterator& rhs) const { return difference_type(i) - difference_type(rhs.i); }
+
+		bool operator== (const packed_iterator& rhs) const { return i == rhs.i; }
+		bool operator!= (const packed_iterator& rhs) const { return i != rhs.i; }
+		bool operator< (const packed_iterator& rhs) const { return i < rhs.i; }
+		bool operator> (const packed_iterator& rhs) const { return i > rhs.i; }
+		bool operator<= (const packed_iterator& rhs) const { return i <= rhs.i; }
+		bool operator>= (const packed_iterator& rhs) const { return i >= rhs.i; }
+
+		template <bool> friend class packed_iterator;
+	};
+
+public:
+	using value_type = std::uint64_t;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = packed_iterator<false>;
+	using const_iterator = packed_iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	static constexpr unsigned bits = Bits;
+	static constexpr std::uint64_t max_value = packed_bits::mask(Bits);
+
+	iterator begin() noexcept { return iterator(this, 0); }
+	iterator end() noexcept { return iterator(this, count); }
+	const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	const_iterator end() const noexcept { return const_iterator(this, count); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	packed_vector() noexcept : words(), count(0) { }
+
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	packed_vector(InputIt first, InputIt last) : packed_vector()
+	{
+		for (; first != last; ++first)
+			push_back(*first);
+	}
+
+	void clear() noexcept
+	{
+		words.clear();
+		count = 0;
+	}
+
+	// Values wider than Bits are truncated.
+	void push_back(std::uint64_t v)
+	{
+		std::size_t need = packed_bits::words_for(count + 1, Bits);
+		while (words.size() < need)
+			words.push_back(0);
+		packed_bits::set(words.data(), count * Bits, Bits, v);
+		++count;
+	}
+
+	void pop_back()
+	{
+		if (count == 0)
+			return;
+		set(--count, 0);
+		words.resize(packed_bits::words_for(count, Bits));
+	}
+
+	std::uint64_t get(std::size_t i) const { return packed_bits::get(words.data(), i * Bits, Bits); }
+	void set(std::size_t i, std::uint64_t v) { packed_bits::set(words.data(), i * Bits, Bits, v); }
+
+	std::uint64_t operator[] (std::size_t i) const { return get(i); }
+	reference operator[] (std::size_t i) { return reference(this, i); }
+
+	std::uint64_t at(std::size_t i) const
+	{
+		if (i >= count)
+			throw std::out_of_range("packed_vector<>: index out of range");
+		return get(i);
+	}
+
+	std::uint64_t front() const { return get(0); }
+	std::uint64_t back() const { return get(count - 1); }
+
+	// Decodes n values starting at first into out.
+	void unpack(std::size_t first, std::size_t n, std::uint64_t* out) const { packed_bits::unpack(words.data(), first, n, Bits, 0, out); }
+
+	std::size_t size() const noexcept { return count; }
+	bool empty() const noexcept { return count == 0; }
+	std::size_t capacity() const noexcept { return words.capacity() * 64 / Bits; }
+	// Bytes of packed storage in use.
+	std::size_t memory_size() const noexcept { return words.size() * sizeof(std::uint64_t); }
+
+	void reserve(std::size_t n) { words.reserve(packed_bits::words_for(n, Bits)); }
+
+	// New values are zero.
+	void resize(std::size_t n)
+	{
+		while (count > n)
+			pop_back();
+		words.resize(packed_bits::words_for(n, Bits), 0);
+		count = n;
+	}
+
+	void shrink_to_fit() { words.shrink_to_fit(); }
+
+	void swap(packed_vector& rhs) noexcept
+	{
+		words.swap(rhs.words);
+		std::swap(count, rhs.count);
+	}
+
+	// Unused bits are kept zero, so equal contents mean equal words.
+	friend bool operator== (const packed_vector& lhs, const packed_vector& rhs) { return lhs.count == rhs.count && lhs.words == rhs.words; }
+	friend bool operator!= (const packed_vector& lhs, const packed_vector& rhs) { return !(lhs == rhs); }
+};
+
+template <unsigned Bits>
+void swap(packed_vector<Bits>& lhs, packed_vector<Bits>& rhs) noexcept { lhs.swap(rhs); }
+
+// Append-only vector of non-decreasing unsigned values, frame-of-reference encoded in blocks
+// of block_size values. The last, partial block is kept uncompressed until it fills.
+class compressed_sorted_vector
+{
+public:
+	static constexpr std::size_t block_size = 128;
+
+private:
+	// Skip index entry, one per compressed block.
+	struct block
+	{
+		std::uint64_t base;   // First (smallest) value of the block.
+		std::size_t offset;   // First word of the block in words.
+		unsigned width;       // Bits per packed offset from base.
+	};
+
+	vector<block> blocks;
+	vector<std::uint64_t> words;   // Packed blocks, each starting on a word boundary.
+	vector<std::uint64_t> pending; // Values of the last, partial block.
+	std::size_t count;
+
+public:
+	// Random access iterator decoding one value per dereference.
+	class const_iterator
+	{
+		const compressed_sorted_vector* v;
+		std::size_t i;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::uint64_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = std::uint64_t;
+		using pointer = void;
+
+		const_iterator() noexcept : v(nullptr), i(0) { }
+		const_iterator(const compressed_sorted_vector* o, std::size_t n) noexcept : v(o), i(n) { }
+
+		reference operator* () const { return (*v)[i]; }
+		reference operator[] (difference_type n) const { return (*v)[i + n]; }
+
+		const_iterator& operator++ () { ++i; return *this; }
+		const_iterator operator++ (int) { const_iterator t(*this); ++i; return t; }
+		const_iterator& operator-- () { --i; return *this; }
+		const_iterator operator-- (int) { const_iterator t(*this); --i; return t; }
+		const_iterator& operator+= (difference_type n) { i += n; return *this; }
+		const_iterator& operator-= (difference_type n) { i -= n; return *this; }
+		const_iterator operator+ (difference_type n) const { return const_iterator(v, i + n); }
+		const_iterator operator- (difference_type n) const { return const_iterator(v, i - n); }
+		friend const_iterator operator+ (difference_type n, const const_iterator& it) { return it + n; }
+		difference_type operator- (const const_iterator& rhs) const { return difference_type(i) - difference_type(rhs.i); }
+
+		bool operator== (const const_iterator& rhs) const { return i == rhs.i; }
+		bool operator!= (const const_iterator& rhs) const { return i != rhs.i; }
+		bool operator< (const const_iterator& rhs) const { return i < rhs.i; }
+		bool operator> (const const_iterator& rhs) const { return i > rhs.i; }
+		bool operator<= (const const_iterator& rhs) const { return i <= rhs.i; }
+		bool operator>= (const const_iterator& rhs) const { return i >= rhs.i; }
+	};
+
+	using value_type = std::uint64_t;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = const_iterator;
+	using reverse_iterator = std::reverse_iterator<const_iterator>;
+	using const_reverse_iterator = reverse_iterator;
+
+	const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	const_iterator end() const noexcept { return const_iterator(this, count); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+
+	compressed_sorted_vector() noexcept : count(0) { }
+
+	// [first, last) must be sorted.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	compressed_sorted_vector(InputIt first, InputIt last) : compressed_sorted_vector()
+	{
+		for (; first != last; ++first)
+			push_back(*first);
+	}
+
+	void clear() noexcept
+	{
+		blocks.clear();
+		words.clear();
+		pending.clear();
+		count = 0;
+	}
+
+	// v must not be smaller than back().
+	void push_back(std::uint64_t v)
+	{
+		pending.push_back(v);
+		++count;
+		if (pending.size() == block_size)
+			seal();
+	}
+
+	std::uint64_t operator[] (std::size_t i) const
+	{
+		std::size_t b = i / block_size;
+		if (b == blocks.size())
+			return pending[i % block_size];
+		const block& k = blocks[b];
+		if (k.width == 0)
+			return k.base;
+		return k.base + packed_bits::get(words.data() + k.offset, (i % block_size) * k.width, k.width);
+	}
+
+	std::uint64_t at(std::size_t i) const
+	{
+		if (i >= count)
+			throw std::out_of_range("compressed_sorted_vector: index out of range");
+		return (*this)[i];
+	}
+
+	std::uint64_t front() const { return (*this)[0]; }
+	std::uint64_t back() const { return (*this)[count - 1]; }
+
+	// Decodes n values starting at first into out, a block at a time.
+	void unpack(std::size_t first, std::size_t n, std::uint64_t* out) const
+	{
+		while (n)
+		{
+			std::size_t b = first / block_size;
+			std::size_t j = first % block_size;
+			std::size_t m = std::min(n, block_size - j);
+
+			if (b == blocks.size())
+				std::copy(pending.begin() + j, pending.begin() + j + m, out);
+			else
+				packed_bits::unpack(words.data() + blocks[b].offset, j, m, blocks[b].width, blocks[b].base, out);
+
+			first += m;
+			out += m;
+			n -= m;
+		}
+	}
+
+	// Index of the first value not less than v (size() if none): binary search over the
+	// block bases, then within the block.
+	std::size_t lower_bound(std::uint64_t v) const
+	{
+		std::size_t lo = 0, hi = blocks.size();
+		while (lo < hi)
+		{
+			std::size_t mid = (lo + hi) / 2;
+			if (blocks[mid].base < v)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		// Block lo starts at or after v, so the answer is in block lo - 1 (or the pending
+		// values after it) or is the start of block lo.
+		std::size_t first = lo ? (lo - 1) * block_size : 0;
+		std::size_t last = lo < blocks.size() ? lo * block_size : count;
+		while (first < last)
+		{
+			std::size_t mid = (first + last) / 2;
+			if ((*this)[mid] < v)
+				first = mid + 1;
+			else
+				last = mid;
+		}
+		return first;
+	}
+
+	bool contains(std::uint64_t v) const
+	{
+		std::size_t i = lower_bound(v);
+		return i < count && (*this)[i] == v;
+	}
+
+	std::size_t size() const noexcept { return count; }
+	bool empty() const noexcept { return count == 0; }
+	// Bytes of encoded storage in use, skip index included.
+	std::size_t memory_size() const noexcept
+	{
+		return words.size() * sizeof(std::uint64_t) + blocks.size() * sizeof(block) + pending.size() * sizeof(std::uint64_t);
+	}
+
+	void shrink_to_fit()
+	{
+		blocks.shrink_to_fit();
+		words.shrink_to_fit();
+	}
+
+	void swap(compressed_sorted_vector& rhs) noexcept
+	{
+		blocks.swap(rhs.blocks);
+		words.swap(rhs.words);
+		pending.swap(rhs.pending);
+		std::swap(count, rhs.count);
+	}
+
+	friend bool operator== (const compressed_sorted_vector& lhs, const compressed_sorted_vector& rhs)
+	{
+		return lhs.count == rhs.count && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	friend bool operator!= (const compressed_sorted_vector& lhs, const compressed_sorted_vector& rhs) { return !(lhs == rhs); }
+
+private:
+	// Encodes the full pending block.
+	void seal()
+	{
+		std::uint64_t base = pending.front();
+		unsigned width = packed_bits::width(pending.back() - base);
+		block k = { base, words.size(), width };
+
+		std::size_t n = packed_bits::words_for(block_size, width);
+		for (std::size_t i = 0; i < n; ++i)
+			words.push_back(0);
+		for (std::size_t i = 0; i < block_size && width; ++i)
+			packed_bits::set(words.data() + k.offset, i * width, width, pending[i] - base);
+
+		blocks.push_back(k);
+		pending.clear();
+	}
+};
+
+inline void swap(compressed_sorted_vector& lhs, compressed_sorted_vector& rhs) noexcept { lhs.swap(rhs); }
+
+#endif
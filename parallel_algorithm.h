@@ -0,0 +1,313 @@
+// Parallel for_each, transform, reduce, sort and inclusive_scan over random access ranges
+// (vector, array, small_vector, plain pointers). Ranges are split into chunks of a grain size
+// that run on a fixed pool of worker threads; the calling thread works too. Ranges shorter
+// than the serial cutoff, and calls made from inside a pool task, run serially.
+// An exception thrown by a task stops the remaining chunks and is rethrown to the caller.
+#ifndef _PARALLEL_ALGORITHM_H_
+#define _PARALLEL_ALGORITHM_H_
+
+#include <algorithm>          // sort, inplace_merge
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <exception>          // exception_ptr
+#include <functional>         // plus, less
+#include <iterator>           // iterator_traits
+#include <mutex>              // mutex
+#include <thread>             // thread
+#include <utility>            // move
+#include "vector.h"
+
+// Fixed set of worker threads running one chunked job at a time.
+class parallel_pool
+{
+	struct job
+	{
+		void (*call)(void*, std::size_t);
+		void* context;
+		std::size_t chunks;
+		std::atomic<std::size_t> next{ 0 };
+		std::size_t workers = 0;  // Pool threads currently inside the job.
+		std::exception_ptr error; // First exception thrown, guarded by the pool mutex.
+	};
+
+	vector<std::thread> threads;
+	std::mutex m;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	job* current = nullptr;      // Job open for joining, null between jobs.
+	unsigned long generation = 0; // Bumped per job so a worker joins each job once.
+	bool stop = false;
+	std::mutex runLock;          // One job at a time.
+
+	static bool& inside_pool()
+	{
+		static thread_local bool inside = false;
+		return inside;
+	}
+
+	void work(job& j)
+	{
+		std::size_t i;
+		while ((i = j.next.fetch_add(1, std::memory_order_relaxed)) < j.chunks)
+		{
+			try
+			{
+				j.call(j.context, i);
+			}
+			catch (...)
+			{
+				j.next.store(j.chunks, std::memory_order_relaxed);
+				std::lock_guard<std::mutex> lock(m);
+				if (!j.error)
+					j.error = std::current_exception();
+			}
+		}
+	}
+
+	void worker()
+	{
+		inside_pool() = true;
+		unsigned long seen = 0;
+		std::unique_lock<std::mutex> lock(m);
+
+		for (;;)
+		{
+			wake.wait(lock, [&] { return stop || (current && generation != seen); });
+			if (stop)
+				return;
+
+			job& j = *current;
+			seen = generation;
+			++j.workers;
+			lock.unlock();
+			work(j);
+			lock.lock();
+			if (--j.workers == 0)
+				finished.notify_all();
+		}
+	}
+
+public:
+	// threads is the total concurrency, the calling thread included.
+	explicit parallel_pool(std::size_t threads = std::thread::hardware_concurrency())
+	{
+		for (std::size_t i = 1; i < threads; ++i)
+			this->threads.emplace_back([this] { worker(); });
+	}
+
+	parallel_pool(const parallel_pool&) = delete;
+	parallel_pool& operator= (const parallel_pool&) = delete;
+
+	~parallel_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m);
+			stop = true;
+		}
+		wake.notify_all();
+		for (std::thread& t : threads)
+			t.join();
+	}
+
+	// Number of threads a job can run on.
+	std::size_t size() const noexcept { return threads.size() + 1; }
+
+	// Process-wide pool with one thread per hardware thread.
+	static parallel_pool& instance()
+	{
+		static parallel_pool pool;
+		return pool;
+	}
+
+	// Calls f(i) for every i in [0, chunks) and returns when all calls are done.
+	template <typename F>
+	void run(std::size_t chunks, F&& f)
+	{
+		if (chunks <= 1 || threads.empty() || inside_pool())
+		{
+			for (std::size_t i = 0; i < chunks; ++i)
+				f(i);
+			return;
+		}
+
+		std::lock_guard<std::mutex> serial(runLock);
+		job j;
+		j.call = [](void* c, std::size_t i) { (*static_cast<typename std::remove_reference<F>::type*>(c))(i); };
+		j.context = static_cast<void*>(&f);
+		j.chunks = chunks;
+
+		{
+			std::lock_guard<std::mutex> lock(m);
+			current = &j;
+			++generation;
+		}
+		wake.notify_all();
+
+		inside_pool() = true;
+		work(j);
+		inside_pool() = false;
+
+		std::unique_lock<std::mutex> lock(m);
+		current = nullptr;
+		finished.wait(lock, [&] { return j.workers == 0; });
+
+		if (j.error)
+			std::rethrow_exception(j.error);
+	}
+};
+
+// Splitting parameters. A grain of 0 picks about 4 chunks per thread, at least 1024 elements.
+struct parallel_config
+{
+	std::size_t grain = 0;
+	std::size_t serial_cutoff = 32768; // Shorter ranges run serially.
+	parallel_pool* pool = nullptr;     // Null selects parallel_pool::instance().
+};
+
+namespace parallel_detail
+{
+	struct split
+	{
+		std::size_t chunks;
+		std::size_t grain;
+		parallel_pool* pool;
+
+		split(std::size_t n, const parallel_config& cfg)
+		{
+			pool = cfg.pool ? cfg.pool : &parallel_pool::instance();
+			if (n < cfg.serial_cutoff || pool->size() == 1)
+				grain = n ? n : 1;
+			else if (cfg.grain)
+				grain = cfg.grain;
+			else
+				grain = std::max<std::size_t>(1024, n / (pool->size() * 4));
+			chunks = (n + grain - 1) / grain;
+		}
+
+		std::size_t begin(std::size_t chunk) const { return chunk * grain; }
+		std::size_t end(std::size_t chunk, std::size_t n) const { return std::min(n, (chunk + 1) * grain); }
+	};
+}
+
+template <typename RandomIt, typename F>
+void parallel_for_each(RandomIt first, RandomIt last, F f, const parallel_config& cfg = parallel_config())
+{
+	std::size_t n = last - first;
+	parallel_detail::split s(n, cfg);
+
+	s.pool->run(s.chunks, [&](std::size_t c)
+	{
+		for (RandomIt it = first + s.begin(c), e = first + s.end(c, n); it != e; ++it)
+			f(*it);
+	});
+}
+
+template <typename RandomIt, typename OutIt, typename F>
+OutIt parallel_transform(RandomIt first, RandomIt last, OutIt out, F f, const parallel_config& cfg = parallel_config())
+{
+	std::size_t n = last - first;
+	parallel_detail::split s(n, cfg);
+
+	s.pool->run(s.chunks, [&](std::size_t c)
+	{
+		std::size_t i = s.begin(c), e = s.end(c, n);
+		std::transform(first + i, first + e, out + i, f);
+	});
+	return out + n;
+}
+
+// op must be associative; chunk results are combined left to right.
+template <typename RandomIt, typename T, typename Op = std::plus<>>
+T parallel_reduce(RandomIt first, RandomIt last, T init, Op op = Op(), const parallel_config& cfg = parallel_config())
+{
+	std::size_t n = last - first;
+	if (n == 0)
+		return init;
+
+	parallel_detail::split s(n, cfg);
+	vector<T> partial;
+	partial.resize(s.chunks, init);
+
+	s.pool->run(s.chunks, [&](std::size_t c)
+	{
+		RandomIt it = first + s.begin(c), e = first + s.end(c, n);
+		T acc = *it;
+		for (++it; it != e; ++it)
+			acc = op(std::move(acc), *it);
+		partial[c] = std::move(acc);
+	});
+
+	for (T& p : partial)
+		init = op(std::move(init), std::move(p));
+	return init;
+}
+
+// Sorts the chunks in parallel, then merges neighbouring runs pairwise, each round in parallel.
+// Not stable.
+template <typename RandomIt, typename Compare = std::less<>>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp = Compare(), const parallel_config& cfg = parallel_config())
+{
+	std::size_t n = last - first;
+	parallel_detail::split s(n, cfg);
+
+	s.pool->run(s.chunks, [&](std::size_t c) { std::sort(first + s.begin(c), first + s.end(c, n), comp); });
+
+	for (std::size_t width = s.grain; width < n; width *= 2)
+	{
+		std::size_t pairs = (n + 2 * width - 1) / (2 * width);
+		s.pool->run(pairs, [&](std::size_t p)
+		{
+			std::size_t lo = p * 2 * width;
+			std::size_t mid = std::min(n, lo + width);
+			std::size_t hi = std::min(n, lo + 2 * width);
+			if (mid < hi)
+				std::inplace_merge(first + lo, first + mid, first + hi, comp);
+		});
+	}
+}
+
+// out[i] = in[0] op ... op in[i]. Three passes: chunk totals in parallel, a serial prefix over
+// the totals, then each chunk scanned in parallel from its offset. op must be associative.
+template <typename RandomIt, typename OutIt, typename Op = std::plus<>>
+OutIt parallel_inclusive_scan(RandomIt first, RandomIt last, OutIt out, Op op = Op(), const parallel_config& cfg = parallel_config())
+{
+	using T = typename std::iterator_traits<RandomIt>::value_type;
+
+	std::size_t n = last - first;
+	if (n == 0)
+		return out;
+
+	parallel_detail::split s(n, cfg);
+	vector<T> offset;
+	offset.resize(s.chunks, *first);
+
+	if (s.chunks > 1)
+	{
+		s.pool->run(s.chunks - 1, [&](std::size_t c)
+		{
+			RandomIt it = first + s.begin(c), e = first + s.end(c, n);
+			T acc = *it;
+			for (++it; it != e; ++it)
+				acc = op(std::move(acc), *it);
+			offset[c + 1] = std::move(acc);
+		});
+		for (std::size_t c = 2; c < s.chunks; ++c)
+			offset[c] = op(offset[c - 1], offset[c]);
+	}
+
+	s.pool->run(s.chunks, [&](std::size_t c)
+	{
+		std::size_t i = s.begin(c), e = s.end(c, n);
+		T acc = c ? op(offset[c], first[i]) : T(first[i]);
+		out[i] = acc;
+		for (++i; i != e; ++i)
+		{
+			acc = op(std::move(acc), first[i]);
+			out[i] = acc;
+		}
+	});
+	return out + n;
+}
+
+#endif
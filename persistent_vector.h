@@ -0,0 +1,495 @@
+// Persistent vector: a 32-way trie of shared nodes plus a tail block, as in Clojure's
+// PersistentVector. Copying is O(1). push_back, set and pop_back leave the vector untouched and
+// return a new version that shares all but one path with it, so snapshots can be read from
+// other threads while a writer keeps producing new versions.
+// transient_vector is the mutable batch mode: it edits nodes it created in place and copies
+// shared ones on first write, then persistent() hands the result back as a snapshot.
+#ifndef _PERSISTENT_VECTOR_H_
+#define _PERSISTENT_VECTOR_H_
+
+#include <algorithm> // copy, equal
+#include <atomic>    // atomic
+#include <cstddef>   // size_t
+#include <cstdint>   // uintptr_t
+#include <iterator>  // random_access_iterator_tag, reverse_iterator
+#include <memory>    // shared_ptr
+#include <stdexcept> // out_of_range
+#include <utility>   // move
+
+template <typename T> class transient_vector;
+
+namespace persistent_vector_detail
+{
+	constexpr unsigned bits = 5;
+	constexpr std::size_t width = std::size_t(1) << bits;
+	constexpr std::size_t mask = width - 1;
+
+	// Nodes created by a transient carry its edit token and may be changed in place by it.
+	// Persistent nodes have token 0.
+	struct node
+	{
+		std::uintptr_t edit;
+		explicit node(std::uintptr_t e) noexcept : edit(e) { }
+	};
+
+	struct branch : node
+	{
+		std::shared_ptr<node> child[width];
+		explicit branch(std::uintptr_t e) noexcept : node(e) { }
+	};
+
+	// Up to width elements; full in the trie, partially filled as the tail.
+	template <typename T>
+	struct leaf : node
+	{
+		std::size_t n;
+		alignas(T) unsigned char storage[width * sizeof(T)];
+
+		explicit leaf(std::uintptr_t e) noexcept : node(e), n(0) { }
+
+		// Copies the first keep elements of rhs.
+		leaf(const leaf& rhs, std::uintptr_t e, std::size_t keep) : node(e), n(0)
+		{
+			try
+			{
+				for (; n < keep; ++n)
+					::new (static_cast<void*>(elements() + n)) T(rhs.elements()[n]);
+			}
+			catch (...)
+			{
+				clear();
+				throw;
+			}
+		}
+
+		leaf(const leaf&) = delete;
+		leaf& operator= (const leaf&) = delete;
+		~leaf() { clear(); }
+
+		T* elements() noexcept { return reinterpret_cast<T*>(storage); }
+		const T* elements() const noexcept { return reinterpret_cast<const T*>(storage); }
+
+		template <typename... Args>
+		void emplace_back(Args&&... args)
+		{
+			::new (static_cast<void*>(elements() + n)) T(std::forward<Args>(args)...);
+			++n;
+		}
+
+		void pop_back() noexcept { elements()[--n].~T(); }
+		void clear() noexcept { while (n) pop_back(); }
+	};
+
+	inline std::uintptr_t new_edit() noexcept
+	{
+		static std::atomic<std::uintptr_t> last(0);
+		return ++last;
+	}
+
+	// The trie and tail of one version. Every operation edits this state; nodes it does not
+	// own under edit (always the case for edit 0) are copied first, so other versions sharing
+	// them are unaffected.
+	template <typename T>
+	struct trie
+	{
+		using node_ptr = std::shared_ptr<node>;
+		using branch_ptr = std::shared_ptr<branch>;
+		using leaf_ptr = std::shared_ptr<leaf<T>>;
+
+		std::size_t count = 0;
+		unsigned shift = bits;  // Level of root; leaves are level 0.
+		branch_ptr root;        // Null while every element fits the tail.
+		leaf_ptr tail;          // Last 1..width elements, null when empty.
+
+		// Index of the first element in the tail.
+		std::size_t tail_offset() const noexcept { return count < width ? 0 : ((count - 1) >> bits) << bits; }
+
+		const leaf<T>* leaf_for(std::size_t i) const noexcept
+		{
+			if (i >= tail_offset())
+				return tail.get();
+			const branch* b = root.get();
+			for (unsigned level = shift; level > bits; level -= bits)
+				b = static_cast<const branch*>(b->child[(i >> level) & mask].get());
+			return static_cast<const leaf<T>*>(b->child[(i >> bits) & mask].get());
+		}
+
+		const T& get(std::size_t i) const noexcept { return leaf_for(i)->elements()[i & mask]; }
+
+		static branch_ptr editable(const branch_ptr& b, std::uintptr_t edit)
+		{
+			if (b && edit && b->edit == edit)
+				return b;
+			branch_ptr copy = std::make_shared<branch>(edit);
+			if (b)
+				std::copy(b->child, b->child + width, copy->child);
+			return copy;
+		}
+
+		static leaf_ptr editable(const leaf_ptr& l, std::uintptr_t edit)
+		{
+			if (edit && l->edit == edit)
+				return l;
+			return std::make_shared<leaf<T>>(*l, edit, l->n);
+		}
+
+		static node_ptr new_path(unsigned level, node_ptr n, std::uintptr_t edit)
+		{
+			if (level == 0)
+				return n;
+			branch_ptr b = std::make_shared<branch>(edit);
+			b->child[0] = new_path(level - bits, std::move(n), edit);
+			return b;
+		}
+
+		// Hangs the full tail off the trie; count still includes the tail.
+		branch_ptr push_tail(unsigned level, const branch_ptr& parent, node_ptr tailNode, std::uintptr_t edit)
+		{
+			branch_ptr b = editable(parent, edit);
+			std::size_t sub = ((count - 1) >> level) & mask;
+
+			if (level == bits)
+				b->child[sub] = std::move(tailNode);
+			else if (b->child[sub])
+				b->child[sub] = push_tail(level - bits, std::static_pointer_cast<branch>(b->child[sub]), std::move(tailNode), edit);
+			else
+				b->child[sub] = new_path(level - bits, std::move(tailNode), edit);
+			return b;
+		}
+
+		// Removes the last leaf from the trie; count still includes the tail element.
+		branch_ptr pop_tail(unsigned level, const branch_ptr& b, std::uintptr_t edit)
+		{
+			std::size_t sub = ((count - 2) >> level) & mask;
+
+			if (level > bits)
+			{
+				branch_ptr child = pop_tail(level - bits, std::static_pointer_cast<branch>(b->child[sub]), edit);
+				if (!child && sub == 0)
+					return nullptr;
+				branch_ptr copy = editable(b, edit);
+				copy->child[sub] = std::move(child);
+				return copy;
+			}
+			if (sub == 0)
+				return nullptr;
+			branch_ptr copy = editable(b, edit);
+			copy->child[sub] = nullptr;
+			return copy;
+		}
+
+		node_ptr assign(unsigned level, const node_ptr& n, std::size_t i, const T& d, std::uintptr_t edit)
+		{
+			if (level == 0)
+			{
+				leaf_ptr l = editable(std::static_pointer_cast<leaf<T>>(n), edit);
+				l->elements()[i & mask] = d;
+				return l;
+			}
+			branch_ptr b = editable(std::static_pointer_cast<branch>(n), edit);
+			std::size_t sub = (i >> level) & mask;
+			b->child[sub] = assign(level - bits, b->child[sub], i, d, edit);
+			return b;
+		}
+
+		template <typename... Args>
+		void emplace_back(std::uintptr_t edit, Args&&... args)
+		{
+			if (tail && count - tail_offset() < width)
+			{
+				leaf_ptr t = editable(tail, edit);
+				t->emplace_back(std::forward<Args>(args)...);
+				tail = std::move(t);
+				++count;
+				return;
+			}
+
+			leaf_ptr newTail = std::make_shared<leaf<T>>(edit);
+			newTail->emplace_back(std::forward<Args>(args)...);
+
+			if (tail)
+			{
+				if ((count >> bits) > (std::size_t(1) << shift))
+				{
+					branch_ptr newRoot = std::make_shared<branch>(edit);
+					newRoot->child[0] = root;
+					newRoot->child[1] = new_path(shift, tail, edit);
+					root = std::move(newRoot);
+					shift += bits;
+				}
+				else
+					root = push_tail(shift, root, tail, edit);
+			}
+			tail = std::move(newTail);
+			++count;
+		}
+
+		void set(std::size_t i, const T& d, std::uintptr_t edit)
+		{
+			if (i >= tail_offset())
+			{
+				leaf_ptr t = editable(tail, edit);
+				t->elements()[i & mask] = d;
+				tail = std::move(t);
+			}
+			else
+				root = std::static_pointer_cast<branch>(assign(shift, root, i, d, edit));
+		}
+
+		void pop_back(std::uintptr_t edit)
+		{
+			if (count == 0)
+				return;
+
+			if (count == 1)
+			{
+				*this = trie();
+				return;
+			}
+
+			if (count - tail_offset() > 1)
+			{
+				if (edit && tail->edit == edit)
+					tail->pop_back();
+				else
+					tail = std::make_shared<leaf<T>>(*tail, edit, tail->n - 1);
+				--count;
+				return;
+			}
+
+			node_ptr n = root;
+			for (unsigned level = shift; level > 0; level -= bits)
+				n = static_cast<const branch*>(n.get())->child[((count - 2) >> level) & mask];
+			leaf_ptr newTail = std::static_pointer_cast<leaf<T>>(std::move(n));
+			branch_ptr newRoot = pop_tail(shift, root, edit);
+
+			if (shift > bits && newRoot && !newRoot->child[1])
+			{
+				newRoot = std::static_pointer_cast<branch>(newRoot->child[0]);
+				shift -= bits;
+			}
+			root = std::move(newRoot);
+			tail = std::move(newTail);
+			--count;
+		}
+	};
+}
+
+template <typename T>
+class persistent_vector
+{
+	using trie = persistent_vector_detail::trie<T>;
+	static constexpr std::size_t width = persistent_vector_detail::width;
+
+	trie t;
+
+	friend class transient_vector<T>;
+	explicit persistent_vector(trie s) noexcept : t(std::move(s)) { }
+
+public:
+	// Random access iterator. Remembers the current block, so stepping costs one trie walk
+	// per 32 elements.
+	class const_iterator
+	{
+		const trie* v;
+		std::size_t i;
+		mutable const T* block;
+		mutable std::size_t base;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using reference = const T&;
+		using pointer = const T*;
+
+		const_iterator() noexcept : v(nullptr), i(0), block(nullptr), base(0) { }
+		const_iterator(const trie* t, std::size_t n) noexcept : v(t), i(n), block(nullptr), base(0) { }
+
+		reference operator* () const
+		{
+			if (!block || i - base >= width)
+			{
+				base = i & ~persistent_vector_detail::mask;
+				block = v->leaf_for(i)->elements();
+			}
+			return block[i - base];
+		}
+
+		pointer operator-> () const { return &**this; }
+		reference operator[] (difference_type n) const { return *(*this + n); }
+
+		const_iterator& operator++ () { ++i; return *this; }
+		const_iterator operator++ (int) { const_iterator c(*this); ++i; return c; }
+		const_iterator& operator-- () { --i; return *this; }
+		const_iterator operator-- (int) { const_iterator c(*this); --i; return c; }
+		const_iterator& operator+= (difference_type n) { i += n; return *this; }
+		const_iterator& operator-= (difference_type n) { i -= n; return *this; }
+		const_iterator operator+ (difference_type n) const { const_iterator c(*this); return c += n; }
+		const_iterator operator- (difference_type n) const { const_iterator c(*this); return c -= n; }
+		friend const_iterator operator+ (difference_type n, const const_iterator& it) { return it + n; }
+		difference_type operator- (const const_iterator& rhs) const { return difference_type(i) - difference_type(rhs.i); }
+
+		bool operator== (const const_iterator& rhs) const { return i == rhs.i; }
+		bool operator!= (const const_iterator& rhs) const { return i != rhs.i; }
+		bool operator< (const const_iterator& rhs) const { return i < rhs.i; }
+		bool operator> (const const_iterator& rhs) const { return i > rhs.i; }
+		bool operator<= (const const_iterator& rhs) const { return i <= rhs.i; }
+		bool operator>= (const const_iterator& rhs) const { return i >= rhs.i; }
+	};
+
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = const_iterator;
+	using reverse_iterator = std::reverse_iterator<const_iterator>;
+	using const_reverse_iterator = reverse_iterator;
+
+	const_iterator begin() const noexcept { return const_iterator(&t, 0); }
+	const_iterator end() const noexcept { return const_iterator(&t, t.count); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+
+	persistent_vector() noexcept = default;
+
+	// Builds through a transient.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	persistent_vector(InputIt first, InputIt last)
+	{
+		transient_vector<T> b;
+		for (; first != last; ++first)
+			b.push_back(*first);
+		*this = b.persistent();
+	}
+
+	// Copies share the whole trie.
+	persistent_vector(const persistent_vector&) = default;
+	persistent_vector(persistent_vector&&) noexcept = default;
+	persistent_vector& operator= (const persistent_vector&) = default;
+	persistent_vector& operator= (persistent_vector&&) noexcept = default;
+
+	// New version with d appended.
+	persistent_vector push_back(const T& d) const { return emplace_back(d); }
+	persistent_vector push_back(T&& d) const { return emplace_back(std::move(d)); }
+
+	template<typename ...Args>
+	persistent_vector emplace_back(Args&&... args) const
+	{
+		trie r(t);
+		r.emplace_back(0, std::forward<Args>(args)...);
+		return persistent_vector(std::move(r));
+	}
+
+	// New version with element i replaced; i == size() appends.
+	persistent_vector set(std::size_t i, const T& d) const
+	{
+		if (i == t.count)
+			return push_back(d);
+		if (i > t.count)
+			throw std::out_of_range("persistent_vector<>: index out of range");
+		trie r(t);
+		r.set(i, d, 0);
+		return persistent_vector(std::move(r));
+	}
+
+	// New version without the last element.
+	persistent_vector pop_back() const
+	{
+		trie r(t);
+		r.pop_back(0);
+		return persistent_vector(std::move(r));
+	}
+
+	// Mutable copy for batches of edits; this version is unaffected.
+	transient_vector<T> transient() const { return transient_vector<T>(t); }
+
+	const T& operator[] (std::size_t i) const { return t.get(i); }
+
+	const T& at(std::size_t i) const
+	{
+		if (i >= t.count)
+			throw std::out_of_range("persistent_vector<>: index out of range");
+		return t.get(i);
+	}
+
+	const T& front() const { return t.get(0); }
+	const T& back() const { return t.get(t.count - 1); }
+
+	std::size_t size() const noexcept { return t.count; }
+	bool empty() const noexcept { return t.count == 0; }
+
+	void swap(persistent_vector& rhs) noexcept { std::swap(t, rhs.t); }
+};
+
+template <typename T>
+class transient_vector
+{
+	using trie = persistent_vector_detail::trie<T>;
+
+	trie t;
+	std::uintptr_t edit; // Token of the nodes this transient may change in place.
+
+	friend class persistent_vector<T>;
+	explicit transient_vector(const trie& s) : t(s), edit(persistent_vector_detail::new_edit()) { }
+
+public:
+	transient_vector() : edit(persistent_vector_detail::new_edit()) { }
+
+	transient_vector(const transient_vector&) = delete;
+	transient_vector& operator= (const transient_vector&) = delete;
+	transient_vector(transient_vector&&) noexcept = default;
+	transient_vector& operator= (transient_vector&&) noexcept = default;
+
+	void push_back(const T& d) { t.emplace_back(edit, d); }
+	void push_back(T&& d) { t.emplace_back(edit, std::move(d)); }
+
+	template<typename ...Args>
+	void emplace_back(Args&&... args) { t.emplace_back(edit, std::forward<Args>(args)...); }
+
+	void set(std::size_t i, const T& d)
+	{
+		if (i == t.count)
+			return push_back(d);
+		if (i > t.count)
+			throw std::out_of_range("transient_vector<>: index out of range");
+		t.set(i, d, edit);
+	}
+
+	void pop_back() { t.pop_back(edit); }
+
+	// Snapshot of the current contents. The transient takes a new token, so later edits
+	// copy the nodes now shared with the snapshot instead of changing them.
+	persistent_vector<T> persistent()
+	{
+		edit = persistent_vector_detail::new_edit();
+		return persistent_vector<T>(t);
+	}
+
+	const T& operator[] (std::size_t i) const { return t.get(i); }
+
+	const T& at(std::size_t i) const
+	{
+		if (i >= t.count)
+			throw std::out_of_range("transient_vector<>: index out of range");
+		return t.get(i);
+	}
+
+	std::size_t size() const noexcept { return t.count; }
+	bool empty() const noexcept { return t.count == 0; }
+};
+
+template <typename T>
+bool operator== (const persistent_vector<T>& lhs, const persistent_vector<T>& rhs)
+{
+	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T>
+bool operator!= (const persistent_vector<T>& lhs, const persistent_vector<T>& rhs) { return !(lhs == rhs); }
+
+template <typename T>
+void swap(persistent_vector<T>& lhs, persistent_vector<T>& rhs) noexcept { lhs.swap(rhs); }
+
+#endif
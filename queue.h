@@ -4,25 +4,35 @@
 #include <iostream>  // cout
 #include <memory>    // smart pointer
 #include <exception> // exceptions
+#if (__cplusplus >= 201703L)
+#include <memory_resource> // polymorphic_allocator
+#endif
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class queue
 {
 protected:
 	struct node
 	{
-		template <typename T> friend class queue;
-
-		explicit node(T e) { element = e; }
+		explicit node(const T& e) : element(e) { }
 
 		T element;
 		std::shared_ptr<node> next = nullptr;
 	};
 
+	// Nodes and their shared_ptr control blocks are allocated together by allocate_shared.
+	using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+
 	std::shared_ptr<node> head = nullptr, tail = nullptr;
+	node_allocator alloc;
 
 public:
+	using allocator_type = Allocator;
+
 	queue() : head(nullptr), tail(nullptr) { }
+	explicit queue(const Allocator& a) : head(nullptr), tail(nullptr), alloc(a) { }
+
+	allocator_type get_allocator() const { return allocator_type(alloc); }
 
 	bool empty() const { return head == nullptr; }
 
@@ -46,7 +56,7 @@ public:
 	// Adds new node to tail of queue.
 	void enqueue(const T& e)
 	{
-		auto newNode{ std::make_shared<node>(e) };
+		auto newNode{ std::allocate_shared<node>(alloc, e) };
 		if (head == nullptr) // Update head pointer.
 			head = newNode;
 		if (tail)            // Update tail pointer.
@@ -79,7 +89,7 @@ public:
 	// Adds new node to head of list.
 	void push_front(const T& e)
 	{
-		auto newNode{ std::make_shared<node>(e) };
+		auto newNode{ std::allocate_shared<node>(alloc, e) };
 		newNode->next = head;
 		head = newNode;
 		if (tail == nullptr)
@@ -87,7 +97,7 @@ public:
 	}
 
 	// Overloaded output operator to display list contents.
-	friend std::ostream& operator<< (std::ostream& os, const queue<T>& q)
+	friend std::ostream& operator<< (std::ostream& os, const queue<T, Allocator>& q)
 	{
 		for (auto node = q.head; node; node = node->next)
 			os << node->element;
@@ -125,4 +135,13 @@ public:
 	iterator end() const { return iterator(tail); }
 };
 
+#if (__cplusplus >= 201703L)
+namespace pmr
+{
+	// Queue drawing its nodes from a std::pmr::memory_resource.
+	template <typename T>
+	using queue = ::queue<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
+
 #endif
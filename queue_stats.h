@@ -0,0 +1,225 @@
+// Telemetry policies for thread_safe_queue (lock_free_queue.h), chosen by its Stats parameter.
+//   no_queue_stats - the default; every hook is empty and the per-slot stamp is an empty base,
+//                    so the instrumentation compiles out completely.
+//   queue_stats    - counts push/pop attempts, successes, full/empty rejections and CAS
+//                    retries, tracks the highest size seen after a push, and keeps a log2
+//                    histogram of the time elements spend in the queue (enqueue to dequeue).
+//                    Counters live in per-thread shards on their own cache lines; snapshot()
+//                    adds them up, and the snapshot exports as JSON or Prometheus text.
+#ifndef _QUEUE_STATS_H_
+#define _QUEUE_STATS_H_
+
+#include <atomic>  // atomic
+#include <chrono>  // steady_clock
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t, int64_t
+#include <cstdio>  // snprintf
+#include <string>  // string
+
+struct no_queue_stats
+{
+	struct stamp { };
+
+	void push_attempt() noexcept { }
+	void push_full() noexcept { }
+	void pop_attempt() noexcept { }
+	void pop_empty() noexcept { }
+	void cas_retry() noexcept { }
+	void pushed(stamp&, std::size_t, const std::atomic<std::size_t>&) noexcept { }
+	void popped(const stamp&) noexcept { }
+};
+
+struct queue_stats_snapshot
+{
+	static constexpr std::size_t sojourn_buckets = 40;
+
+	std::uint64_t push_attempts = 0;
+	std::uint64_t pushes = 0;
+	std::uint64_t push_full = 0;
+	std::uint64_t pop_attempts = 0;
+	std::uint64_t pops = 0;
+	std::uint64_t pop_empty = 0;
+	std::uint64_t cas_retries = 0;
+	std::uint64_t high_watermark = 0;
+	std::uint64_t sojourn_ns_sum = 0;
+	std::uint64_t sojourn[sojourn_buckets] = { }; // Bucket i: [2^i, 2^(i+1)) ns; the last one is open-ended.
+
+	std::string to_json() const
+	{
+		std::string s = "{";
+		field(s, "push_attempts", push_attempts);
+		field(s, "pushes", pushes);
+		field(s, "push_full", push_full);
+		field(s, "pop_attempts", pop_attempts);
+		field(s, "pops", pops);
+		field(s, "pop_empty", pop_empty);
+		field(s, "cas_retries", cas_retries);
+		field(s, "high_watermark", high_watermark);
+		field(s, "sojourn_ns_sum", sojourn_ns_sum);
+		s += "\"sojourn_ns_buckets\":[";
+		for (std::size_t i = 0; i < sojourn_buckets; ++i)
+		{
+			if (i)
+				s += ',';
+			std::string lt = i + 1 < sojourn_buckets ? std::to_string(std::uint64_t(1) << (i + 1)) : "null";
+			s += "{\"lt\":" + lt + ",\"count\":" + std::to_string(sojourn[i]) + '}';
+		}
+		return s + "]}";
+	}
+
+	// Prometheus text exposition format; every metric name starts with name.
+	std::string to_prometheus(const std::string& name) const
+	{
+		std::string s;
+		metric(s, name, "push_attempts_total", "counter", push_attempts);
+		metric(s, name, "pushes_total", "counter", pushes);
+		metric(s, name, "push_full_total", "counter", push_full);
+		metric(s, name, "pop_attempts_total", "counter", pop_attempts);
+		metric(s, name, "pops_total", "counter", pops);
+		metric(s, name, "pop_empty_total", "counter", pop_empty);
+		metric(s, name, "cas_retries_total", "counter", cas_retries);
+		metric(s, name, "high_watermark", "gauge", high_watermark);
+
+		std::string h = name + "_sojourn_seconds";
+		s += "# TYPE " + h + " histogram\n";
+		std::uint64_t cumulative = 0;
+		char le[32];
+		for (std::size_t i = 0; i + 1 < sojourn_buckets; ++i)
+		{
+			cumulative += sojourn[i];
+			std::snprintf(le, sizeof(le), "%g", double(std::uint64_t(1) << (i + 1)) * 1e-9);
+			s += h + "_bucket{le=\"" + le + "\"} " + std::to_string(cumulative) + '\n';
+		}
+		cumulative += sojourn[sojourn_buckets - 1];
+		s += h + "_bucket{le=\"+Inf\"} " + std::to_string(cumulative) + '\n';
+		std::snprintf(le, sizeof(le), "%.9g", double(sojourn_ns_sum) * 1e-9);
+		s += h + "_sum " + le + '\n';
+		s += h + "_count " + std::to_string(cumulative) + '\n';
+		return s;
+	}
+
+private:
+	static void field(std::string& s, const char* key, std::uint64_t value)
+	{
+		s += '"';
+		s += key;
+		s += "\":" + std::to_string(value) + ',';
+	}
+
+	static void metric(std::string& s, const std::string& name, const char* suffix, const char* type, std::uint64_t value)
+	{
+		std::string full = name + '_' + suffix;
+		s += "# TYPE " + full + ' ' + type + '\n' + full + ' ' + std::to_string(value) + '\n';
+	}
+};
+
+class queue_stats
+{
+public:
+	static constexpr std::size_t shard_count = 64;
+	static constexpr std::size_t sojourn_buckets = queue_stats_snapshot::sojourn_buckets;
+
+	struct stamp
+	{
+		std::int64_t enqueued; // steady_clock nanoseconds.
+	};
+
+	void push_attempt() noexcept { bump(local().pushAttempts); }
+	void push_full() noexcept { bump(local().pushFull); }
+	void pop_attempt() noexcept { bump(local().popAttempts); }
+	void pop_empty() noexcept { bump(local().popEmpty); }
+	void cas_retry() noexcept { bump(local().casRetries); }
+
+	// ticket is the tail position just filled; size is measured against head.
+	void pushed(stamp& s, std::size_t ticket, const std::atomic<std::size_t>& head) noexcept
+	{
+		shard& sh = local();
+		bump(sh.pushes);
+		std::uint64_t size = ticket + 1 - head.load(std::memory_order_relaxed);
+		if (size > sh.highWatermark.load(std::memory_order_relaxed) && size <= (std::uint64_t(1) << 62))
+			sh.highWatermark.store(size, std::memory_order_relaxed);
+		s.enqueued = now();
+	}
+
+	void popped(const stamp& s) noexcept
+	{
+		shard& sh = local();
+		bump(sh.pops);
+		std::int64_t d = now() - s.enqueued;
+		std::uint64_t ns = d > 0 ? std::uint64_t(d) : 0;
+		sh.sojournSum.fetch_add(ns, std::memory_order_relaxed);
+		bump(sh.sojourn[bucket(ns)]);
+	}
+
+	// Sums the shards. Consistent only when the queue is idle; otherwise each counter is a
+	// recent value.
+	queue_stats_snapshot snapshot() const
+	{
+		queue_stats_snapshot r;
+		for (const shard& sh : shards)
+		{
+			r.push_attempts += sh.pushAttempts.load(std::memory_order_relaxed);
+			r.pushes += sh.pushes.load(std::memory_order_relaxed);
+			r.push_full += sh.pushFull.load(std::memory_order_relaxed);
+			r.pop_attempts += sh.popAttempts.load(std::memory_order_relaxed);
+			r.pops += sh.pops.load(std::memory_order_relaxed);
+			r.pop_empty += sh.popEmpty.load(std::memory_order_relaxed);
+			r.cas_retries += sh.casRetries.load(std::memory_order_relaxed);
+			std::uint64_t w = sh.highWatermark.load(std::memory_order_relaxed);
+			if (w > r.high_watermark)
+				r.high_watermark = w;
+			r.sojourn_ns_sum += sh.sojournSum.load(std::memory_order_relaxed);
+			for (std::size_t i = 0; i < sojourn_buckets; ++i)
+				r.sojourn[i] += sh.sojourn[i].load(std::memory_order_relaxed);
+		}
+		return r;
+	}
+
+private:
+	struct alignas(64) shard
+	{
+		std::atomic<std::uint64_t> pushAttempts{ 0 };
+		std::atomic<std::uint64_t> pushes{ 0 };
+		std::atomic<std::uint64_t> pushFull{ 0 };
+		std::atomic<std::uint64_t> popAttempts{ 0 };
+		std::atomic<std::uint64_t> pops{ 0 };
+		std::atomic<std::uint64_t> popEmpty{ 0 };
+		std::atomic<std::uint64_t> casRetries{ 0 };
+		std::atomic<std::uint64_t> highWatermark{ 0 };
+		std::atomic<std::uint64_t> sojournSum{ 0 };
+		std::atomic<std::uint64_t> sojourn[sojourn_buckets] = { };
+	};
+
+	shard shards[shard_count];
+
+	static void bump(std::atomic<std::uint64_t>& c) noexcept { c.fetch_add(1, std::memory_order_relaxed); }
+
+	static std::int64_t now() noexcept
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// floor(log2(ns)), clamped to the last bucket; 0 and 1 ns share bucket 0.
+	static std::size_t bucket(std::uint64_t ns) noexcept
+	{
+		std::size_t b = 0;
+#if defined(__GNUC__) || defined(__clang__)
+		if (ns > 1)
+			b = std::size_t(63 - __builtin_clzll(ns));
+#else
+		while (ns >>= 1)
+			++b;
+#endif
+		return b < sojourn_buckets ? b : sojourn_buckets - 1;
+	}
+
+	// Each thread gets a dense number on first use and keeps its shard for every queue.
+	shard& local() noexcept
+	{
+		static std::atomic<std::size_t> next{ 0 };
+		static thread_local std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+		return shards[index];
+	}
+};
+
+#endif
@@ -0,0 +1,226 @@
+// Stable LSD radix sort for unsigned, signed and floating point keys, either the elements
+// themselves or a key extracted from each element. Keys are mapped to unsigned integers that
+// order the same way (sign bit flipped, negative floats inverted), so -0.0 sorts before 0.0
+// and NaNs with the sign bit clear sort after +infinity.
+// Digits are 8 bits for 1 and 2 byte keys and 11 bits for wider ones. All digit histograms
+// come from a single pass, and a digit every key shares is skipped.
+// radix_sort_nodes does the same for linked nodes by relinking them, see list and dlist.
+#ifndef _RADIX_SORT_H_
+#define _RADIX_SORT_H_
+
+#include <algorithm>   // stable_sort
+#include <cstddef>     // size_t
+#include <cstdint>     // uint8_t ... uint64_t
+#include <cstring>     // memcpy
+#include <iterator>    // iterator_traits
+#include <memory>      // allocator
+#include <type_traits> // is_arithmetic
+#include <utility>     // move
+#include "vector.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RADIX_PREFETCH(p) __builtin_prefetch(p, 1)
+#else
+#define RADIX_PREFETCH(p) ((void)0)
+#endif
+
+// Default key: the element itself.
+struct radix_identity
+{
+	template <typename T>
+	const T& operator() (const T& x) const noexcept { return x; }
+};
+
+namespace radix_detail
+{
+	template <std::size_t N> struct unsigned_of;
+	template <> struct unsigned_of<1> { using type = std::uint8_t; };
+	template <> struct unsigned_of<2> { using type = std::uint16_t; };
+	template <> struct unsigned_of<4> { using type = std::uint32_t; };
+	template <> struct unsigned_of<8> { using type = std::uint64_t; };
+
+	// Unsigned image of k with the same order.
+	template <typename K>
+	typename unsigned_of<sizeof(K)>::type ordered_bits(K k) noexcept
+	{
+		static_assert(std::is_arithmetic<K>::value, "radix_sort: key must be an arithmetic type");
+		using U = typename unsigned_of<sizeof(K)>::type;
+		constexpr U sign = U(U(1) << (sizeof(K) * 8 - 1));
+
+		U u;
+		std::memcpy(&u, &k, sizeof(K));
+		if constexpr (std::is_floating_point<K>::value)
+			return (u & sign) ? U(~u) : U(u | sign);
+		else if constexpr (std::is_signed<K>::value)
+			return U(u ^ sign);
+		else
+			return u;
+	}
+
+	template <typename T, typename Key>
+	using key_type = typename std::decay<decltype(std::declval<Key&>()(std::declval<const T&>()))>::type;
+
+	template <typename K>
+	struct digits
+	{
+		static constexpr unsigned bits = sizeof(K) <= 2 ? 8 : 11;
+		static constexpr std::size_t radix = std::size_t(1) << bits;
+		static constexpr unsigned passes = (sizeof(K) * 8 + bits - 1) / bits;
+
+		template <typename U>
+		static std::size_t at(U u, unsigned pass) noexcept { return std::size_t(u >> (pass * bits)) & (radix - 1); }
+	};
+}
+
+// Sorts [first, last) by key(element). Elements are moved between the range and a buffer once
+// per digit that is not skipped.
+template <typename RandomIt, typename Key>
+void radix_sort(RandomIt first, RandomIt last, Key key)
+{
+	using T = typename std::iterator_traits<RandomIt>::value_type;
+	using K = radix_detail::key_type<T, Key>;
+	using D = radix_detail::digits<K>;
+	static_assert(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value,
+		"radix_sort: elements must be nothrow movable");
+
+	std::size_t n = last - first;
+	auto bits = [&key](const T& x) { return radix_detail::ordered_bits(static_cast<K>(key(x))); };
+
+	if (n < 64)
+	{
+		std::stable_sort(first, last, [&bits](const T& a, const T& b) { return bits(a) < bits(b); });
+		return;
+	}
+
+	vector<std::size_t> count;
+	count.resize(D::passes * D::radix, 0);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		auto u = bits(first[i]);
+		for (unsigned p = 0; p < D::passes; ++p)
+			++count[p * D::radix + D::at(u, p)];
+	}
+
+	std::allocator<T> alloc;
+	T* buffer = alloc.allocate(n);
+	bool constructed = false; // buffer holds live elements
+	bool inBuffer = false;    // the current order is in buffer
+
+	for (unsigned p = 0; p < D::passes; ++p)
+	{
+		std::size_t* c = &count[p * D::radix];
+		if (c[D::at(bits(inBuffer ? buffer[0] : first[0]), p)] == n)
+			continue; // Every key has the same digit.
+
+		std::size_t sum = 0;
+		for (std::size_t d = 0; d < D::radix; ++d)
+		{
+			std::size_t k = c[d];
+			c[d] = sum;
+			sum += k;
+		}
+
+		constexpr std::size_t ahead = 16;
+		if (!inBuffer)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				if (i + ahead < n)
+					RADIX_PREFETCH(buffer + c[D::at(bits(first[i + ahead]), p)]);
+				T* dst = buffer + c[D::at(bits(first[i]), p)]++;
+				if (constructed)
+					*dst = std::move(first[i]);
+				else
+					::new (static_cast<void*>(dst)) T(std::move(first[i]));
+			}
+			constructed = true;
+		}
+		else
+		{
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				if (i + ahead < n)
+					RADIX_PREFETCH(&*(first + c[D::at(bits(buffer[i + ahead]), p)]));
+				first[c[D::at(bits(buffer[i]), p)]++] = std::move(buffer[i]);
+			}
+		}
+		inBuffer = !inBuffer;
+	}
+
+	if (inBuffer)
+		std::move(buffer, buffer + n, first);
+	if (constructed)
+		for (std::size_t i = 0; i < n; ++i)
+			buffer[i].~T();
+	alloc.deallocate(buffer, n);
+}
+
+template <typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last) { radix_sort(first, last, radix_identity()); }
+
+// Sorts the null-terminated chain starting at head, relinking through next(node) (a reference
+// to the node's next pointer) by key_of(node). Returns the new last node; head is updated.
+template <typename Node, typename Next, typename KeyOf>
+Node* radix_sort_nodes(Node*& head, Next next, KeyOf key_of)
+{
+	using K = typename std::decay<decltype(key_of(head))>::type;
+	using U = typename radix_detail::unsigned_of<sizeof(K)>::type;
+	constexpr unsigned bits = 8;
+	constexpr std::size_t radix = 256;
+	constexpr unsigned passes = sizeof(K);
+
+	if (!head)
+		return nullptr;
+
+	// Histograms only serve to find digits every key shares.
+	vector<std::size_t> count;
+	count.resize(passes * radix, 0);
+	std::size_t n = 0;
+	Node* last = head;
+	for (Node* p = head; p; p = next(p), ++n)
+	{
+		U u = radix_detail::ordered_bits(static_cast<K>(key_of(p)));
+		for (unsigned d = 0; d < passes; ++d)
+			++count[d * radix + ((u >> (d * bits)) & (radix - 1))];
+		last = p;
+	}
+
+	Node* bucketHead[radix];
+	Node* bucketTail[radix];
+
+	for (unsigned d = 0; d < passes; ++d)
+	{
+		U u0 = radix_detail::ordered_bits(static_cast<K>(key_of(head)));
+		if (count[d * radix + ((u0 >> (d * bits)) & (radix - 1))] == n)
+			continue;
+
+		std::fill(bucketHead, bucketHead + radix, nullptr);
+		for (Node* p = head; p; )
+		{
+			Node* following = next(p);
+			std::size_t b = (radix_detail::ordered_bits(static_cast<K>(key_of(p))) >> (d * bits)) & (radix - 1);
+			if (bucketHead[b])
+				next(bucketTail[b]) = p;
+			else
+				bucketHead[b] = p;
+			bucketTail[b] = p;
+			p = following;
+		}
+
+		Node** link = &head;
+		for (std::size_t b = 0; b < radix; ++b)
+		{
+			if (!bucketHead[b])
+				continue;
+			*link = bucketHead[b];
+			link = &next(bucketTail[b]);
+			last = bucketTail[b];
+		}
+		*link = nullptr;
+	}
+	return last;
+}
+
+#undef RADIX_PREFETCH
+
+#endif
@@ -0,0 +1,291 @@
+// Vector made of fixed-size blocks listed in a block table. Growth adds a block and never moves
+// existing elements, so pointers and references stay valid until their element is erased;
+// iterators are invalidated by growth of the table. Indexing is a shift and a mask.
+#ifndef _SEGMENTED_VECTOR_H_
+#define _SEGMENTED_VECTOR_H_
+
+#include <cstddef>   // size_t
+#include <iterator>  // random_access_iterator_tag, reverse_iterator
+#include <memory>    // allocator
+#include <stdexcept> // out_of_range
+#include "vector.h"
+
+// Largest power of two that keeps a block around 4 KiB, at least 16 elements.
+template <typename T>
+constexpr std::size_t segmented_vector_block_size()
+{
+	std::size_t n = 16;
+	while (n * 2 * sizeof(T) <= 4096)
+		n *= 2;
+	return n;
+}
+
+template <typename T, std::size_t BlockSize = segmented_vector_block_size<T>()>
+class segmented_vector
+{
+	static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0, "segmented_vector<>: block size must be a power of two");
+
+	static constexpr std::size_t shift = [] { std::size_t s = 0; while ((std::size_t(1) << s) != BlockSize) ++s; return s; }();
+	static constexpr std::size_t mask = BlockSize - 1;
+
+	vector<T*> blocks;  // Block table; every block holds BlockSize slots.
+	std::size_t count;  // Number of actually stored objects.
+
+	template <bool Const>
+	class block_iterator
+	{
+		using table = T* const*;
+
+		table b;
+		std::size_t i;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using reference = typename std::conditional<Const, const T&, T&>::type;
+		using pointer = typename std::conditional<Const, const T*, T*>::type;
+
+		block_iterator() noexcept : b(nullptr), i(0) { }
+		block_iterator(table t, std::size_t n) noexcept : b(t), i(n) { }
+		template <bool C, typename = typename std::enable_if<Const && !C>::type>
+		block_iterator(const block_iterator<C>& rhs) noexcept : b(rhs.b), i(rhs.i) { }
+
+		reference operator* () const { return b[i >> shift][i & mask]; }
+		pointer operator-> () const { return &**this; }
+		reference operator[] (difference_type n) const { return *(*this + n); }
+
+		block_iterator& operator++ () { ++i; return *this; }
+		block_iterator operator++ (int) { block_iterator t(*this); ++i; return t; }
+		block_iterator& operator-- () { --i; return *this; }
+		block_iterator operator-- (int) { block_iterator t(*this); --i; return t; }
+		block_iterator& operator+= (difference_type n) { i += n; return *this; }
+		block_iterator& operator-= (difference_type n) { i -= n; return *this; }
+		block_iterator operator+ (difference_type n) const { return block_iterator(b, i + n); }
+		block_iterator operator- (difference_type n) const { return block_iterator(b, i - n); }
+		friend block_iterator operator+ (difference_type n, const block_iterator& it) { return it + n; }
+		difference_type operator- (const block_iterator& rhs) const { return difference_type(i) - difference_type(rhs.i); }
+
+		bool operator== (const block_iterator& rhs) const { return i == rhs.i; }
+		bool operator!= (const block_iterator& rhs) const { return i != rhs.i; }
+		bool operator< (const block_iterator& rhs) const { return i < rhs.i; }
+		bool operator> (const block_iterator& rhs) const { return i > rhs.i; }
+		bool operator<= (const block_iterator& rhs) const { return i <= rhs.i; }
+		bool operator>= (const block_iterator& rhs) const { return i >= rhs.i; }
+
+		template <bool> friend class block_iterator;
+	};
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = block_iterator<false>;
+	using const_iterator = block_iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	iterator begin() noexcept { return iterator(blocks.data(), 0); }
+	iterator end() noexcept { return iterator(blocks.data(), count); }
+	const_iterator begin() const noexcept { return const_iterator(blocks.data(), 0); }
+	const_iterator end() const noexcept { return const_iterator(blocks.data(), count); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	segmented_vector() noexcept : blocks(), count(0) { }
+
+	// Copy ctor. The delegated ctor has completed, so a throwing copy runs the dtor.
+	segmented_vector(const segmented_vector& rhs) : segmented_vector()
+	{
+		reserve(rhs.count);
+		for (const T& e : rhs)
+			push_back(e);
+	}
+
+	// Move ctor.
+	segmented_vector(segmented_vector&& rhs) noexcept : blocks(std::move(rhs.blocks)), count(rhs.count) { rhs.count = 0; }
+
+	segmented_vector& operator= (const segmented_vector& rhs)
+	{
+		if (this != &rhs)
+			segmented_vector(rhs).swap(*this);
+		return *this;
+	}
+
+	segmented_vector& operator= (segmented_vector&& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			clear();
+			release(0);
+			blocks = std::move(rhs.blocks);
+			count = rhs.count;
+			rhs.count = 0;
+		}
+		return *this;
+	}
+
+	~segmented_vector()
+	{
+		clear();
+		release(0);
+	}
+
+	// Destroys all elements, keeps the blocks.
+	void clear() noexcept
+	{
+		while (count > 0)
+			pop_back();
+	}
+
+	void push_back(const T& d) { emplace_back(d); }
+	void push_back(T&& d) { emplace_back(std::move(d)); }
+
+	// Existing elements never move, so args may refer into this vector.
+	template<typename ...Args>
+	T& emplace_back(Args&&... args)
+	{
+		if ((count >> shift) == blocks.size())
+			add_block();
+		T* p = slot(count);
+		::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+		++count;
+		return *p;
+	}
+
+	void pop_back()
+	{
+		if (count == 0)
+			return;
+		slot(--count)->~T();
+	}
+
+	T& operator[] (std::size_t i) { return *slot(i); }
+	const T& operator[] (std::size_t i) const { return *slot(i); }
+
+	T& at(std::size_t i)
+	{
+		if (i >= count)
+			throw std::out_of_range("segmented_vector<>: index out of range");
+		return *slot(i);
+	}
+
+	const T& at(std::size_t i) const
+	{
+		if (i >= count)
+			throw std::out_of_range("segmented_vector<>: index out of range");
+		return *slot(i);
+	}
+
+	T& front() { return *slot(0); }
+	const T& front() const { return *slot(0); }
+	T& back() { return *slot(count - 1); }
+	const T& back() const { return *slot(count - 1); }
+
+	std::size_t size() const noexcept { return count; }
+	bool empty() const noexcept { return count == 0; }
+	std::size_t max_size() const noexcept { return std::numeric_limits<std::size_t>::max() / sizeof(T); }
+	std::size_t capacity() const noexcept { return blocks.size() * BlockSize; }
+	static constexpr std::size_t block_size() noexcept { return BlockSize; }
+	std::size_t block_count() const noexcept { return blocks.size(); }
+
+	// Adds blocks until n elements fit.
+	void reserve(std::size_t n)
+	{
+		while (capacity() < n)
+			add_block();
+	}
+
+	void resize(std::size_t n)
+	{
+		while (count > n)
+			pop_back();
+		reserve(n);
+		while (count < n)
+			emplace_back();
+	}
+
+	void resize(std::size_t n, const T& d)
+	{
+		while (count > n)
+			pop_back();
+		reserve(n);
+		while (count < n)
+			emplace_back(d);
+	}
+
+	// Frees the blocks past the last element.
+	void shrink_to_fit()
+	{
+		release((count + mask) >> shift);
+		blocks.shrink_to_fit();
+	}
+
+	void swap(segmented_vector& rhs) noexcept
+	{
+		blocks.swap(rhs.blocks);
+		std::swap(count, rhs.count);
+	}
+
+private:
+	T* slot(std::size_t i) const noexcept { return blocks[i >> shift] + (i & mask); }
+
+	void add_block()
+	{
+		T* b = std::allocator<T>().allocate(BlockSize);
+		try
+		{
+			blocks.push_back(b);
+		}
+		catch (...)
+		{
+			std::allocator<T>().deallocate(b, BlockSize);
+			throw;
+		}
+	}
+
+	// Frees the blocks from index n on; they must hold no elements.
+	void release(std::size_t n) noexcept
+	{
+		while (blocks.size() > n)
+		{
+			std::allocator<T>().deallocate(blocks.back(), BlockSize);
+			blocks.pop_back();
+		}
+	}
+};
+
+template <typename T, std::size_t B>
+bool operator== (const segmented_vector<T, B>& lhs, const segmented_vector<T, B>& rhs)
+{
+	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T, std::size_t B>
+bool operator!= (const segmented_vector<T, B>& lhs, const segmented_vector<T, B>& rhs) { return !(lhs == rhs); }
+
+template <typename T, std::size_t B>
+bool operator< (const segmented_vector<T, B>& lhs, const segmented_vector<T, B>& rhs)
+{
+	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, std::size_t B>
+bool operator> (const segmented_vector<T, B>& lhs, const segmented_vector<T, B>& rhs) { return rhs < lhs; }
+
+template <typename T, std::size_t B>
+bool operator<= (const segmented_vector<T, B>& lhs, const segmented_vector<T, B>& rhs) { return !(rhs < lhs); }
+
+template <typename T, std::size_t B>
+bool operator>= (const segmented_vector<T, B>& lhs, const segmented_vector<T, B>& rhs) { return !(lhs < rhs); }
+
+template <typename T, std::size_t B>
+void swap(segmented_vector<T, B>& lhs, segmented_vector<T, B>& rhs) noexcept { lhs.swap(rhs); }
+
+#endif
@@ -0,0 +1,153 @@
+// MPMC queue front-end spreading contention over N thread_safe_queue shards (lock_free_queue.h),
+// so producers on different cores stop fighting over one tail cache line.
+// Consumers pop from their home shard first, then steal from the others round-robin.
+//   sharded_queue<T>       - relaxed FIFO: producers push to the shard of the CPU they run on
+//                            and spill into the next shards when it is full. Each shard is
+//                            FIFO, the queue as a whole is not.
+//   sharded_queue<T, true> - strict per-producer FIFO: a producer thread always pushes to the
+//                            same shard and never spills, so its elements are popped in the
+//                            order it pushed them; push fails when that shard is full.
+#ifndef _SHARDED_QUEUE_H_
+#define _SHARDED_QUEUE_H_
+
+#include <atomic>      // atomic
+#include <cstddef>     // size_t
+#include <memory>      // allocator
+#include <thread>      // hardware_concurrency
+#include <type_traits> // is_nothrow_constructible
+#include <utility>     // move, forward
+#include "lock_free_queue.h"
+
+#if defined(__linux__)
+#include <sched.h> // sched_getcpu
+#endif
+
+template <typename T, bool PerProducerFifo = false>
+class sharded_queue
+{
+	using shard_type = thread_safe_queue<T>;
+
+	shard_type* shards;
+	std::size_t count;
+
+	// Dense per-thread number, handed out on first use; spreads threads evenly over the shards.
+	static std::size_t thread_index()
+	{
+		static std::atomic<std::size_t> next{ 0 };
+		static thread_local std::size_t index = next.fetch_add(1, std::memory_order_relaxed);
+		return index;
+	}
+
+	// Shard a producer starts at: fixed per thread for strict FIFO, the current CPU otherwise.
+	std::size_t producer_shard() const
+	{
+#if defined(__linux__)
+		if (!PerProducerFifo)
+		{
+			int cpu = sched_getcpu();
+			if (cpu >= 0)
+				return std::size_t(cpu) % count;
+		}
+#endif
+		return thread_index() % count;
+	}
+
+	template <typename... Args>
+	bool offer(Args&&... args)
+	{
+		std::size_t home = producer_shard();
+		if (shards[home].emplace(std::forward<Args>(args)...))
+			return true;
+		if (PerProducerFifo)
+			return false;
+
+		for (std::size_t i = 1; i < count; ++i)
+			if (shards[(home + i) % count].emplace(std::forward<Args>(args)...))
+				return true;
+		return false;
+	}
+
+public:
+	// shardCount 0 means one shard per hardware thread; capacity is per shard.
+	explicit sharded_queue(std::size_t capacity, std::size_t shardCount = 0)
+	{
+		if (shardCount == 0)
+			shardCount = std::thread::hardware_concurrency();
+		count = shardCount ? shardCount : 1;
+
+		shards = std::allocator<shard_type>().allocate(count);
+		std::size_t i = 0;
+		try
+		{
+			for (; i < count; ++i)
+				new (&shards[i]) shard_type(capacity);
+		}
+		catch (...)
+		{
+			while (i-- > 0)
+				shards[i].~shard_type();
+			std::allocator<shard_type>().deallocate(shards, count);
+			throw;
+		}
+	}
+
+	sharded_queue(const sharded_queue&) = delete;
+	sharded_queue& operator= (const sharded_queue&) = delete;
+
+	~sharded_queue()
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			shards[i].~shard_type();
+		std::allocator<shard_type>().deallocate(shards, count);
+	}
+
+	std::size_t shard_count() const { return count; }
+	std::size_t capacity() const { return count * shards[0].capacity(); }
+
+	// Approximate while other threads push or pop.
+	std::size_t size() const
+	{
+		std::size_t n = 0;
+		for (std::size_t i = 0; i < count; ++i)
+			n += shards[i].size();
+		return n;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	bool push(const T& data) { return emplace(data); }
+	bool push(T&& data) { return emplace(std::move(data)); }
+
+	// Returns false when the producer's shard is full (strict FIFO) or all shards are (relaxed).
+	// A shard that turns out to be full has not consumed the arguments, so they can be offered
+	// to the next one, unless constructing T may throw: then the shard builds a temporary from
+	// them before claiming a slot, and the element is built once here and moved instead.
+	template <typename... Args>
+	bool emplace(Args&&... args)
+	{
+		if constexpr (!std::is_nothrow_constructible<T, Args&&...>::value)
+		{
+			T element(std::forward<Args>(args)...);
+			return offer(std::move(element));
+		}
+		else
+			return offer(std::forward<Args>(args)...);
+	}
+
+	// Pops from the calling thread's home shard, else steals from the others round-robin.
+	// Returns false when every shard looked empty.
+	bool pop(T& result)
+	{
+		std::size_t home = thread_index() % count;
+		for (std::size_t i = 0; i < count; ++i)
+			if (shards[(home + i) % count].pop(result))
+				return true;
+		return false;
+	}
+
+	// Direct access, e.g. for a consumer pinned to one shard.
+	shard_type& shard(std::size_t i) { return shards[i]; }
+	const shard_type& shard(std::size_t i) const { return shards[i]; }
+};
+
+#endif
@@ -0,0 +1,539 @@
+// Vectorized scans over contiguous arithmetic data: find, count, contains, equal, mismatch,
+// min_element, max_element and sum. On x86-64 SSE2 is used, or AVX2 when the CPU supports it
+// (checked once at runtime). Other targets and element types use plain loops.
+// Floating point sums are accumulated in several lanes, so rounding may differ from a serial
+// sum. For data containing NaNs, min/max return some element of the range, not necessarily the
+// one std::min_element/std::max_element would.
+#ifndef _SIMD_SCAN_H_
+#define _SIMD_SCAN_H_
+
+#include <cstddef>     // size_t
+#include <cstdint>     // uint64_t
+#include <cstring>     // memcmp
+#include <type_traits> // is_integral
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_SCAN_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace simd
+{
+	// Result type of sum: 64-bit for integers, T otherwise.
+	template <typename T>
+	using sum_type = typename std::conditional<!std::is_integral<T>::value, T,
+		typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type>::type;
+
+	namespace detail
+	{
+		// Element types with SIMD kernels.
+		template <typename T>
+		struct vectorizable : std::integral_constant<bool,
+			(std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8) ||
+			std::is_same<T, float>::value || std::is_same<T, double>::value> { };
+
+		// Types whose equality is bytewise equality.
+		template <typename T>
+		struct bitwise_comparable : std::integral_constant<bool,
+			std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> { };
+
+		inline unsigned ctz(unsigned m)
+		{
+#if defined(_MSC_VER)
+			unsigned long i;
+			_BitScanForward(&i, m);
+			return i;
+#else
+			return __builtin_ctz(m);
+#endif
+		}
+
+		inline unsigned popcount(unsigned m)
+		{
+#if defined(_MSC_VER)
+			m = m - ((m >> 1) & 0x55555555u);
+			m = (m & 0x33333333u) + ((m >> 2) & 0x33333333u);
+			return (((m + (m >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+#else
+			return __builtin_popcount(m);
+#endif
+		}
+
+		// Integer sums wrap on overflow rather than being undefined.
+		template <typename T>
+		sum_type<T> add(sum_type<T> a, sum_type<T> b)
+		{
+			if constexpr (std::is_integral<T>::value)
+				return static_cast<sum_type<T>>(static_cast<unsigned long long>(a) + static_cast<unsigned long long>(b));
+			else
+				return a + b;
+		}
+
+		// Fallback loops, also used for the tails of the vector kernels.
+		namespace scalar
+		{
+			template <typename T>
+			const T* find(const T* first, const T* last, const T& value)
+			{
+				for (; first != last; ++first)
+					if (*first == value)
+						break;
+				return first;
+			}
+
+			template <typename T>
+			std::size_t count(const T* first, const T* last, const T& value)
+			{
+				std::size_t n = 0;
+				for (; first != last; ++first)
+					if (*first == value)
+						n++;
+				return n;
+			}
+
+			template <typename T>
+			const T* mismatch(const T* first1, const T* last1, const T* first2)
+			{
+				for (; first1 != last1; ++first1, ++first2)
+					if (*first1 != *first2)
+						break;
+				return first1;
+			}
+
+			template <typename T>
+			const T* min_element(const T* first, const T* last)
+			{
+				const T* best = first;
+				for (; first != last; ++first)
+					if (*first < *best)
+						best = first;
+				return best;
+			}
+
+			template <typename T>
+			const T* max_element(const T* first, const T* last)
+			{
+				const T* best = first;
+				for (; first != last; ++first)
+					if (*best < *first)
+						best = first;
+				return best;
+			}
+
+			template <typename T>
+			sum_type<T> sum(const T* first, const T* last)
+			{
+				sum_type<T> s = sum_type<T>();
+				for (; first != last; ++first)
+					s = add<T>(s, static_cast<sum_type<T>>(*first));
+				return s;
+			}
+		}
+
+#ifdef SIMD_SCAN_X86
+		inline bool has_avx2()
+		{
+			static const bool avx2 = []
+			{
+#if defined(_MSC_VER)
+				int info[4];
+				__cpuid(info, 0);
+				if (info[0] < 7)
+					return false;
+				__cpuid(info, 1);
+				bool osxsave = (info[2] & (1 << 27)) != 0;
+				__cpuidex(info, 7, 0);
+				return osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6;
+#else
+				return __builtin_cpu_supports("avx2") != 0;
+#endif
+			}();
+			return avx2;
+		}
+
+		// SSE2 is part of the x86-64 baseline. Operations it lacks (64-bit compare,
+		// signed byte and 32-bit min/max) are emulated with bias or select tricks.
+		namespace sse2
+		{
+			template <typename T, typename = void>
+			struct ops;
+
+			template <typename T>
+			struct ops<T, typename std::enable_if<std::is_integral<T>::value>::type>
+			{
+				using reg = __m128i;
+				using acc = __m128i; // 64-bit lanes.
+				static constexpr std::size_t lanes = sizeof(reg) / sizeof(T);
+				static constexpr unsigned full = 0xffffu;
+				static constexpr bool has_minmax = sizeof(T) < 8;
+				static constexpr bool has_sum = sizeof(T) >= 4;
+
+				static reg load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+				static void store(T* p, reg a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a); }
+
+				static reg set1(T v)
+				{
+					if constexpr (sizeof(T) == 1)
+						return _mm_set1_epi8(static_cast<char>(v));
+					else if constexpr (sizeof(T) == 2)
+						return _mm_set1_epi16(static_cast<short>(v));
+					else if constexpr (sizeof(T) == 4)
+						return _mm_set1_epi32(static_cast<int>(v));
+					else
+						return _mm_set1_epi64x(static_cast<long long>(v));
+				}
+
+				// Byte mask of equal elements.
+				static unsigned eq(reg a, reg b)
+				{
+					if constexpr (sizeof(T) == 1)
+						return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+					else if constexpr (sizeof(T) == 2)
+						return _mm_movemask_epi8(_mm_cmpeq_epi16(a, b));
+					else if constexpr (sizeof(T) == 4)
+						return _mm_movemask_epi8(_mm_cmpeq_epi32(a, b));
+					else
+					{
+						// Equal 64-bit lanes have both 32-bit halves equal.
+						reg c = _mm_cmpeq_epi32(a, b);
+						return _mm_movemask_epi8(_mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1))));
+					}
+				}
+
+				// Flips the sign bit where needed so that the native comparison applies.
+				static reg bias(reg a)
+				{
+					if constexpr (sizeof(T) == 1 && std::is_signed<T>::value)
+						return _mm_xor_si128(a, _mm_set1_epi8(static_cast<char>(0x80)));
+					else if constexpr (sizeof(T) == 2 && !std::is_signed<T>::value)
+						return _mm_xor_si128(a, _mm_set1_epi16(static_cast<short>(0x8000)));
+					else if constexpr (sizeof(T) == 4 && !std::is_signed<T>::value)
+						return _mm_xor_si128(a, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+					else
+						return a;
+				}
+
+				static reg select(reg mask, reg a, reg b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+				static reg min(reg a, reg b)
+				{
+					if constexpr (sizeof(T) == 1)
+						return bias(_mm_min_epu8(bias(a), bias(b)));
+					else if constexpr (sizeof(T) == 2)
+						return bias(_mm_min_epi16(bias(a), bias(b)));
+					else
+						return select(_mm_cmpgt_epi32(bias(a), bias(b)), b, a);
+				}
+
+				static reg max(reg a, reg b)
+				{
+					if constexpr (sizeof(T) == 1)
+						return bias(_mm_max_epu8(bias(a), bias(b)));
+					else if constexpr (sizeof(T) == 2)
+						return bias(_mm_max_epi16(bias(a), bias(b)));
+					else
+						return select(_mm_cmpgt_epi32(bias(a), bias(b)), a, b);
+				}
+
+				static acc zero() { return _mm_setzero_si128(); }
+
+				static acc add(acc s, reg a)
+				{
+					if constexpr (sizeof(T) == 4)
+					{
+						reg high = std::is_signed<T>::value ? _mm_srai_epi32(a, 31) : _mm_setzero_si128();
+						return _mm_add_epi64(s, _mm_add_epi64(_mm_unpacklo_epi32(a, high), _mm_unpackhi_epi32(a, high)));
+					}
+					else
+						return _mm_add_epi64(s, a);
+				}
+
+				static acc merge(acc a, acc b) { return _mm_add_epi64(a, b); }
+
+				static sum_type<T> reduce(acc s)
+				{
+					std::uint64_t v[2];
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(v), s);
+					return static_cast<sum_type<T>>(v[0] + v[1]);
+				}
+			};
+
+			template <>
+			struct ops<float>
+			{
+				using reg = __m128;
+				using acc = __m128;
+				static constexpr std::size_t lanes = 4;
+				static constexpr unsigned full = 0xffffu;
+				static constexpr bool has_minmax = true;
+				static constexpr bool has_sum = true;
+
+				static reg load(const float* p) { return _mm_loadu_ps(p); }
+				static void store(float* p, reg a) { _mm_storeu_ps(p, a); }
+				static reg set1(float v) { return _mm_set1_ps(v); }
+				static unsigned eq(reg a, reg b) { return _mm_movemask_epi8(_mm_castps_si128(_mm_cmpeq_ps(a, b))); }
+				static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+				static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+				static acc zero() { return _mm_setzero_ps(); }
+				static acc add(acc s, reg a) { return _mm_add_ps(s, a); }
+				static acc merge(acc a, acc b) { return _mm_add_ps(a, b); }
+
+				static float reduce(acc s)
+				{
+					float v[4];
+					_mm_storeu_ps(v, s);
+					return (v[0] + v[1]) + (v[2] + v[3]);
+				}
+			};
+
+			template <>
+			struct ops<double>
+			{
+				using reg = __m128d;
+				using acc = __m128d;
+				static constexpr std::size_t lanes = 2;
+				static constexpr unsigned full = 0xffffu;
+				static constexpr bool has_minmax = true;
+				static constexpr bool has_sum = true;
+
+				static reg load(const double* p) { return _mm_loadu_pd(p); }
+				static void store(double* p, reg a) { _mm_storeu_pd(p, a); }
+				static reg set1(double v) { return _mm_set1_pd(v); }
+				static unsigned eq(reg a, reg b) { return _mm_movemask_epi8(_mm_castpd_si128(_mm_cmpeq_pd(a, b))); }
+				static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+				static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+				static acc zero() { return _mm_setzero_pd(); }
+				static acc add(acc s, reg a) { return _mm_add_pd(s, a); }
+				static acc merge(acc a, acc b) { return _mm_add_pd(a, b); }
+
+				static double reduce(acc s)
+				{
+					double v[2];
+					_mm_storeu_pd(v, s);
+					return v[0] + v[1];
+				}
+			};
+
+#include "simd_scan_kernels.h"
+		}
+
+		// Everything in the AVX2 back end is compiled for AVX2 and only called after has_avx2().
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+		namespace avx2
+		{
+			template <typename T, typename = void>
+			struct ops;
+
+			template <typename T>
+			struct ops<T, typename std::enable_if<std::is_integral<T>::value>::type>
+			{
+				using reg = __m256i;
+				using acc = __m256i; // 64-bit lanes.
+				static constexpr std::size_t lanes = sizeof(reg) / sizeof(T);
+				static constexpr unsigned full = 0xffffffffu;
+				static constexpr bool has_minmax = sizeof(T) < 8;
+				static constexpr bool has_sum = sizeof(T) >= 4;
+
+				static reg load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+				static void store(T* p, reg a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+
+				static reg set1(T v)
+				{
+					if constexpr (sizeof(T) == 1)
+						return _mm256_set1_epi8(static_cast<char>(v));
+					else if constexpr (sizeof(T) == 2)
+						return _mm256_set1_epi16(static_cast<short>(v));
+					else if constexpr (sizeof(T) == 4)
+						return _mm256_set1_epi32(static_cast<int>(v));
+					else
+						return _mm256_set1_epi64x(static_cast<long long>(v));
+				}
+
+				// Byte mask of equal elements.
+				static unsigned eq(reg a, reg b)
+				{
+					if constexpr (sizeof(T) == 1)
+						return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+					else if constexpr (sizeof(T) == 2)
+						return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b)));
+					else if constexpr (sizeof(T) == 4)
+						return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)));
+					else
+						return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(a, b)));
+				}
+
+				static reg min(reg a, reg b)
+				{
+					constexpr bool s = std::is_signed<T>::value;
+					if constexpr (sizeof(T) == 1)
+						return s ? _mm256_min_epi8(a, b) : _mm256_min_epu8(a, b);
+					else if constexpr (sizeof(T) == 2)
+						return s ? _mm256_min_epi16(a, b) : _mm256_min_epu16(a, b);
+					else
+						return s ? _mm256_min_epi32(a, b) : _mm256_min_epu32(a, b);
+				}
+
+				static reg max(reg a, reg b)
+				{
+					constexpr bool s = std::is_signed<T>::value;
+					if constexpr (sizeof(T) == 1)
+						return s ? _mm256_max_epi8(a, b) : _mm256_max_epu8(a, b);
+					else if constexpr (sizeof(T) == 2)
+						return s ? _mm256_max_epi16(a, b) : _mm256_max_epu16(a, b);
+					else
+						return s ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b);
+				}
+
+				static acc zero() { return _mm256_setzero_si256(); }
+
+				static acc add(acc s, reg a)
+				{
+					if constexpr (sizeof(T) == 4)
+					{
+						__m128i lo = _mm256_castsi256_si128(a), hi = _mm256_extracti128_si256(a, 1);
+						if constexpr (std::is_signed<T>::value)
+							return _mm256_add_epi64(s, _mm256_add_epi64(_mm256_cvtepi32_epi64(lo), _mm256_cvtepi32_epi64(hi)));
+						else
+							return _mm256_add_epi64(s, _mm256_add_epi64(_mm256_cvtepu32_epi64(lo), _mm256_cvtepu32_epi64(hi)));
+					}
+					else
+						return _mm256_add_epi64(s, a);
+				}
+
+				static acc merge(acc a, acc b) { return _mm256_add_epi64(a, b); }
+
+				static sum_type<T> reduce(acc s)
+				{
+					std::uint64_t v[4];
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(v), s);
+					return static_cast<sum_type<T>>((v[0] + v[1]) + (v[2] + v[3]));
+				}
+			};
+
+			template <>
+			struct ops<float>
+			{
+				using reg = __m256;
+				using acc = __m256;
+				static constexpr std::size_t lanes = 8;
+				static constexpr unsigned full = 0xffffffffu;
+				static constexpr bool has_minmax = true;
+				static constexpr bool has_sum = true;
+
+				static reg load(const float* p) { return _mm256_loadu_ps(p); }
+				static void store(float* p, reg a) { _mm256_storeu_ps(p, a); }
+				static reg set1(float v) { return _mm256_set1_ps(v); }
+				static unsigned eq(reg a, reg b) { return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)))); }
+				static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+				static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+				static acc zero() { return _mm256_setzero_ps(); }
+				static acc add(acc s, reg a) { return _mm256_add_ps(s, a); }
+				static acc merge(acc a, acc b) { return _mm256_add_ps(a, b); }
+
+				static float reduce(acc s)
+				{
+					float v[8];
+					_mm256_storeu_ps(v, s);
+					return ((v[0] + v[1]) + (v[2] + v[3])) + ((v[4] + v[5]) + (v[6] + v[7]));
+				}
+			};
+
+			template <>
+			struct ops<double>
+			{
+				using reg = __m256d;
+				using acc = __m256d;
+				static constexpr std::size_t lanes = 4;
+				static constexpr unsigned full = 0xffffffffu;
+				static constexpr bool has_minmax = true;
+				static constexpr bool has_sum = true;
+
+				static reg load(const double* p) { return _mm256_loadu_pd(p); }
+				static void store(double* p, reg a) { _mm256_storeu_pd(p, a); }
+				static reg set1(double v) { return _mm256_set1_pd(v); }
+				static unsigned eq(reg a, reg b) { return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)))); }
+				static reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+				static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+				static acc zero() { return _mm256_setzero_pd(); }
+				static acc add(acc s, reg a) { return _mm256_add_pd(s, a); }
+				static acc merge(acc a, acc b) { return _mm256_add_pd(a, b); }
+
+				static double reduce(acc s)
+				{
+					double v[4];
+					_mm256_storeu_pd(v, s);
+					return (v[0] + v[1]) + (v[2] + v[3]);
+				}
+			};
+
+#include "simd_scan_kernels.h"
+		}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif // SIMD_SCAN_X86
+	}
+
+	// Selects the widest available back end for vectorizable T, the scalar loop otherwise.
+#ifdef SIMD_SCAN_X86
+#define SIMD_SCAN_DISPATCH(T, call) \
+	if constexpr (detail::vectorizable<T>::value) \
+	{ \
+		if (detail::has_avx2()) \
+			return detail::avx2::call; \
+		return detail::sse2::call; \
+	} \
+	else \
+		return detail::scalar::call
+#else
+#define SIMD_SCAN_DISPATCH(T, call) return detail::scalar::call
+#endif
+
+	template <typename T>
+	const T* find(const T* first, const T* last, const T& value) { SIMD_SCAN_DISPATCH(T, find(first, last, value)); }
+
+	template <typename T>
+	std::size_t count(const T* first, const T* last, const T& value) { SIMD_SCAN_DISPATCH(T, count(first, last, value)); }
+
+	template <typename T>
+	bool contains(const T* first, const T* last, const T& value) { return find(first, last, value) != last; }
+
+	// First position in [first1, last1) that differs from the range starting at first2.
+	template <typename T>
+	const T* mismatch(const T* first1, const T* last1, const T* first2) { SIMD_SCAN_DISPATCH(T, mismatch(first1, last1, first2)); }
+
+	// Bitwise comparable types are compared with memcmp.
+	template <typename T>
+	bool equal(const T* first1, const T* last1, const T* first2)
+	{
+		if constexpr (detail::bitwise_comparable<T>::value)
+			return first1 == last1 || std::memcmp(first1, first2, (last1 - first1) * sizeof(T)) == 0;
+		else
+			return mismatch(first1, last1, first2) == last1;
+	}
+
+	// First smallest element, last if the range is empty.
+	template <typename T>
+	const T* min_element(const T* first, const T* last) { SIMD_SCAN_DISPATCH(T, min_element(first, last)); }
+
+	// First largest element, last if the range is empty.
+	template <typename T>
+	const T* max_element(const T* first, const T* last) { SIMD_SCAN_DISPATCH(T, max_element(first, last)); }
+
+	template <typename T>
+	sum_type<T> sum(const T* first, const T* last) { SIMD_SCAN_DISPATCH(T, sum(first, last)); }
+
+#undef SIMD_SCAN_DISPATCH
+}
+
+#endif
@@ -0,0 +1,127 @@
+// Loops shared by the SSE2 and AVX2 back ends of simd_scan.h. Included once per instruction
+// set, inside that back end's namespace and next to its ops<T>, so there is no include guard.
+// Elements that do not fill a whole register are handled by the scalar loops.
+
+template <typename T>
+const T* find(const T* first, const T* last, T value)
+{
+	using O = ops<T>;
+	const typename O::reg v = O::set1(value);
+
+	for (; static_cast<std::size_t>(last - first) >= O::lanes; first += O::lanes)
+		if (unsigned m = O::eq(O::load(first), v))
+			return first + ctz(m) / sizeof(T);
+
+	return scalar::find(first, last, value);
+}
+
+template <typename T>
+std::size_t count(const T* first, const T* last, T value)
+{
+	using O = ops<T>;
+	const typename O::reg v = O::set1(value);
+	std::size_t n = 0; // Matching bytes, sizeof(T) per element.
+
+	for (; static_cast<std::size_t>(last - first) >= O::lanes; first += O::lanes)
+		n += popcount(O::eq(O::load(first), v));
+
+	return n / sizeof(T) + scalar::count(first, last, value);
+}
+
+template <typename T>
+const T* mismatch(const T* first1, const T* last1, const T* first2)
+{
+	using O = ops<T>;
+
+	for (; static_cast<std::size_t>(last1 - first1) >= O::lanes; first1 += O::lanes, first2 += O::lanes)
+	{
+		unsigned m = O::eq(O::load(first1), O::load(first2));
+		if (m != O::full)
+			return first1 + ctz(~m & O::full) / sizeof(T);
+	}
+
+	return scalar::mismatch(first1, last1, first2);
+}
+
+template <bool Min, typename O>
+typename O::reg pick(typename O::reg a, typename O::reg b)
+{
+	if constexpr (Min)
+		return O::min(a, b);
+	else
+		return O::max(a, b);
+}
+
+// Reduces to the extreme value with four independent accumulators, then locates its first
+// occurrence, which is the element std::min_element/std::max_element would return.
+// Data containing NaNs takes the scalar path, so the result always points into a non-empty range.
+template <bool Min, typename T>
+const T* extreme_element(const T* first, const T* last)
+{
+	using O = ops<T>;
+
+	if constexpr (!O::has_minmax)
+		return Min ? scalar::min_element(first, last) : scalar::max_element(first, last);
+	else
+	{
+		if (static_cast<std::size_t>(last - first) < O::lanes)
+			return Min ? scalar::min_element(first, last) : scalar::max_element(first, last);
+
+		const T* p = first + O::lanes;
+		typename O::reg a0 = O::load(first), a1 = a0, a2 = a0, a3 = a0;
+
+		for (; static_cast<std::size_t>(last - p) >= 4 * O::lanes; p += 4 * O::lanes)
+		{
+			a0 = pick<Min, O>(a0, O::load(p));
+			a1 = pick<Min, O>(a1, O::load(p + O::lanes));
+			a2 = pick<Min, O>(a2, O::load(p + 2 * O::lanes));
+			a3 = pick<Min, O>(a3, O::load(p + 3 * O::lanes));
+		}
+		for (; static_cast<std::size_t>(last - p) >= O::lanes; p += O::lanes)
+			a0 = pick<Min, O>(a0, O::load(p));
+
+		T values[O::lanes];
+		O::store(values, pick<Min, O>(pick<Min, O>(a0, a1), pick<Min, O>(a2, a3)));
+
+		T best = Min ? *scalar::min_element(values, values + O::lanes) : *scalar::max_element(values, values + O::lanes);
+		for (; p != last; ++p)
+			if (Min ? (*p < best) : (best < *p))
+				best = *p;
+
+		// A NaN can win the reduction, and find cannot locate it (NaN != NaN).
+		if (best != best)
+			return Min ? scalar::min_element(first, last) : scalar::max_element(first, last);
+		return find(first, last, best);
+	}
+}
+
+template <typename T>
+const T* min_element(const T* first, const T* last) { return extreme_element<true>(first, last); }
+
+template <typename T>
+const T* max_element(const T* first, const T* last) { return extreme_element<false>(first, last); }
+
+template <typename T>
+sum_type<T> sum(const T* first, const T* last)
+{
+	using O = ops<T>;
+
+	if constexpr (!O::has_sum)
+		return scalar::sum(first, last);
+	else
+	{
+		typename O::acc a0 = O::zero(), a1 = a0, a2 = a0, a3 = a0;
+
+		for (; static_cast<std::size_t>(last - first) >= 4 * O::lanes; first += 4 * O::lanes)
+		{
+			a0 = O::add(a0, O::load(first));
+			a1 = O::add(a1, O::load(first + O::lanes));
+			a2 = O::add(a2, O::load(first + 2 * O::lanes));
+			a3 = O::add(a3, O::load(first + 3 * O::lanes));
+		}
+		for (; static_cast<std::size_t>(last - first) >= O::lanes; first += O::lanes)
+			a0 = O::add(a0, O::load(first));
+
+		return add<T>(O::reduce(O::merge(O::merge(a0, a1), O::merge(a2, a3))), scalar::sum(first, last));
+	}
+}
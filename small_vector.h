@@ -0,0 +1,419 @@
+// Vector with N elements of inline storage. Spills to the heap only when it grows past N.
+#ifndef _SMALL_VECTOR_H_
+#define _SMALL_VECTOR_H_
+
+#include "vector.h" // uninitialized_relocate, simd_scan.h
+
+template <typename T, std::size_t N = 8>
+class small_vector
+{
+	static_assert(N > 0, "small_vector<>: inline capacity must be non-zero");
+
+	std::size_t count;        // Number of actually stored objects.
+	std::size_t reservedSize; // N while inline, heap allocation size otherwise.
+	T* elements;              // Points at buffer or at heap storage.
+	alignas(T) unsigned char buffer[N * sizeof(T)]; // Inline storage.
+
+public:
+	using value_type = T;
+	using allocator_type = std::allocator<T>;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = T * ;
+	using const_iterator = const T*;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	iterator begin() noexcept { return elements; }
+	iterator end() noexcept { return begin() + count; }
+	const_iterator begin() const noexcept { return elements; }
+	const_iterator end() const noexcept { return begin() + count; }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	small_vector() noexcept : count(0), reservedSize(N), elements(inline_data()) { }
+
+	// Heap storage, when needed, always comes from std::allocator.
+	allocator_type get_allocator() const noexcept { return allocator_type(); }
+
+	// Copy ctor.
+	small_vector(const small_vector& rhs) : small_vector()
+	{
+		reserve(rhs.count);
+		std::uninitialized_copy(rhs.begin(), rhs.end(), elements);
+		count = rhs.count;
+	}
+
+	// Move ctor. Heap storage is stolen, inline elements are relocated.
+	small_vector(small_vector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) : small_vector()
+	{
+		take(rhs);
+	}
+
+	small_vector& operator= (const small_vector& rhs)
+	{
+		if (this != &rhs)
+			small_vector(rhs).swap(*this);
+		return *this;
+	}
+
+	small_vector& operator= (small_vector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+	{
+		if (this != &rhs)
+		{
+			clear();
+			release();
+			take(rhs);
+		}
+		return *this;
+	}
+
+	~small_vector()
+	{
+		clear();
+		release();
+	}
+
+	void clear() noexcept
+	{
+		while (0 < count)
+			elements[--count].~T();
+	}
+
+	void push_back(const T& d) { emplace_back(d); }
+	void push_back(T&& d) { emplace_back(std::move(d)); }
+
+	template<typename ...Args>
+	T& emplace_back(Args&&... args)
+	{
+		if (reservedSize == count)
+		{
+			// Construct first in case args refer to an element of this vector.
+			T temp(std::forward<Args>(args)...);
+			reallocate(reservedSize * 2);
+			::new (static_cast<void*>(elements + count)) T(std::move(temp));
+		}
+		else
+			::new (static_cast<void*>(elements + count)) T(std::forward<Args>(args)...);
+		return elements[count++];
+	}
+
+	void pop_back()
+	{
+		if (count == 0)
+			return;
+		elements[--count].~T();
+	}
+
+	const T& operator[] (std::size_t i) const { return elements[i]; }
+	T& operator[] (std::size_t i) { return elements[i]; }
+
+	const T& at(std::size_t i) const { return elements[i]; }
+	T& at(std::size_t i) { return elements[i]; }
+
+	T* data() noexcept { return elements; }
+	const T* data() const noexcept { return elements; }
+
+	T& front() const { return elements[0]; }
+	T& back() const { return elements[count - 1]; }
+
+	template<typename ...Args>
+	iterator emplace(const_iterator it, Args&&... args)
+	{
+		std::size_t i = it - cbegin();
+
+		if (i > count)
+			return end();
+
+		if (i == count)
+		{
+			emplace_back(std::forward<Args>(args)...);
+			return begin() + i;
+		}
+
+		T temp(std::forward<Args>(args)...);
+
+		if (reservedSize == count)
+			reallocate(reservedSize * 2);
+
+		::new (static_cast<void*>(elements + count)) T(std::move(elements[count - 1]));
+		std::move_backward((begin() + i), (end() - 1), end());
+		elements[i] = std::move(temp);
+		count++;
+
+		return begin() + i;
+	}
+
+	iterator insert(const_iterator it, const T& d) { return emplace(it, d); }
+	iterator insert(const_iterator it, T&& d) { return emplace(it, std::move(d)); }
+
+	// Inserts [first, last) before it. Forward ranges grow the storage at most once; the range
+	// must not point into this vector.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	iterator insert(const_iterator it, InputIt first, InputIt last)
+	{
+		std::size_t i = it - cbegin();
+
+		if (i > count)
+			return end();
+
+		using category = typename std::iterator_traits<InputIt>::iterator_category;
+		if constexpr (!std::is_base_of<std::forward_iterator_tag, category>::value)
+		{
+			for (std::size_t j = i; first != last; ++first)
+				emplace(cbegin() + j++, *first);
+		}
+		else
+		{
+			std::size_t n = std::distance(first, last);
+
+			if (n == 0)
+				return begin() + i;
+
+			if (count + n > reservedSize)
+				reallocate(std::max(count + n, reservedSize * 2));
+			insert_in_place(i, n, first, last);
+		}
+		return begin() + i;
+	}
+
+	// Appends [first, last), growing at most once for forward ranges.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	void append(InputIt first, InputIt last) { insert(cend(), first, last); }
+
+	iterator erase(const_iterator it) { return erase(it, it + 1); }
+
+	// Erase [first, last).
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		std::size_t pos = first - cbegin();
+		std::size_t n = last - first;
+
+		if (pos >= count || n == 0)
+			return begin() + pos;
+
+		if constexpr (std::is_trivially_copyable<T>::value)
+			std::memmove(static_cast<void*>(elements + pos), static_cast<const void*>(elements + pos + n), (count - pos - n) * sizeof(T));
+		else
+			std::move((begin() + pos + n), end(), (begin() + pos));
+		while (n--)
+			elements[--count].~T();
+
+		return begin() + pos;
+	}
+
+	// Replaces the contents with n copies of d.
+	void assign(const std::size_t n, const T& d)
+	{
+		T temp(d); // d may refer to an element of this vector.
+		clear();
+		reserve(n);
+		for (; count < n; count++)
+			::new (static_cast<void*>(elements + count)) T(temp);
+	}
+
+	// Replaces the contents with [first, last), reserving once for forward ranges.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	void assign(InputIt first, InputIt last)
+	{
+		clear();
+		using category = typename std::iterator_traits<InputIt>::iterator_category;
+		if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+			reserve(std::distance(first, last));
+		for (; first != last; ++first)
+			emplace_back(*first);
+	}
+
+	// Vectorized for arithmetic T (simd_scan.h).
+	iterator find(const T& d) { return const_cast<iterator>(simd::find(cbegin(), cend(), d)); }
+	const_iterator find(const T& d) const { return simd::find(cbegin(), cend(), d); }
+	std::size_t count_of(const T& d) const { return simd::count(cbegin(), cend(), d); }
+	bool contains(const T& d) const { return simd::contains(cbegin(), cend(), d); }
+	iterator min_element() { return const_cast<iterator>(simd::min_element(cbegin(), cend())); }
+	const_iterator min_element() const { return simd::min_element(cbegin(), cend()); }
+	iterator max_element() { return const_cast<iterator>(simd::max_element(cbegin(), cend())); }
+	const_iterator max_element() const { return simd::max_element(cbegin(), cend()); }
+	simd::sum_type<T> sum() const { return simd::sum(cbegin(), cend()); }
+
+	void swap(small_vector& rhs)
+	{
+		small_vector temp(std::move(rhs));
+		rhs = std::move(*this);
+		*this = std::move(temp);
+	}
+
+	std::size_t size() const noexcept { return count; }
+	bool empty() const noexcept { return count == 0; }
+	std::size_t max_size() const noexcept { return std::numeric_limits<std::size_t>::max() / sizeof(T); }
+	std::size_t capacity() const noexcept { return reservedSize; }
+	static constexpr std::size_t inline_capacity() noexcept { return N; }
+	// True while elements live in the inline buffer.
+	bool is_inline() const noexcept { return elements == inline_data(); }
+
+	void reserve(std::size_t n)
+	{
+		if (n > reservedSize)
+			reallocate(n);
+	}
+
+	void resize(std::size_t n)
+	{
+		while (count > n)
+			elements[--count].~T();
+		reserve(n);
+		for (; count < n; count++)
+			::new (static_cast<void*>(elements + count)) T();
+	}
+
+	void resize(std::size_t n, const T& d)
+	{
+		T temp(d);
+		while (count > n)
+			elements[--count].~T();
+		reserve(n);
+		for (; count < n; count++)
+			::new (static_cast<void*>(elements + count)) T(temp);
+	}
+
+	// Moves back into the inline buffer when the elements fit.
+	void shrink_to_fit()
+	{
+		if (count < reservedSize && !is_inline())
+			reallocate(count);
+	}
+
+private:
+	T* inline_data() noexcept { return reinterpret_cast<T*>(buffer); }
+	const T* inline_data() const noexcept { return reinterpret_cast<const T*>(buffer); }
+
+	// Range insert with sufficient capacity. Trivially copyable elements are shifted
+	// with one memmove, others are moved backward so no live element is overwritten.
+	template<typename ForwardIt>
+	void insert_in_place(std::size_t i, std::size_t n, ForwardIt first, ForwardIt last)
+	{
+		T* pos = elements + i;
+		T* oldEnd = elements + count;
+		std::size_t after = count - i;
+
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos), after * sizeof(T));
+			std::copy(first, last, pos);
+			count += n;
+		}
+		else if (after > n)
+		{
+			for (T* p = oldEnd - n; p != oldEnd; ++p, ++count)
+				::new (static_cast<void*>(elements + count)) T(std::move(*p));
+			std::move_backward(pos, oldEnd - n, oldEnd);
+			std::copy(first, last, pos);
+		}
+		else
+		{
+			ForwardIt mid = first;
+			std::advance(mid, after);
+			for (ForwardIt it = mid; it != last; ++it, ++count)
+				::new (static_cast<void*>(elements + count)) T(*it);
+			for (T* p = pos; p != oldEnd; ++p, ++count)
+				::new (static_cast<void*>(elements + count)) T(std::move(*p));
+			std::copy(first, mid, pos);
+		}
+	}
+
+	// Frees heap storage (elements must already be destroyed) and returns to the inline buffer.
+	void release() noexcept
+	{
+		if (!is_inline())
+			std::allocator<T>().deallocate(elements, reservedSize);
+		elements = inline_data();
+		reservedSize = N;
+	}
+
+	// Takes rhs's elements, leaving rhs empty. This must be empty and inline.
+	void take(small_vector& rhs)
+	{
+		if (rhs.is_inline())
+		{
+			uninitialized_relocate(rhs.elements, rhs.elements + rhs.count, elements);
+			count = rhs.count;
+		}
+		else
+		{
+			elements = rhs.elements;
+			reservedSize = rhs.reservedSize;
+			count = rhs.count;
+			rhs.elements = rhs.inline_data();
+			rhs.reservedSize = N;
+		}
+		rhs.count = 0;
+	}
+
+	// Moves contents into storage of n elements (n >= count); inline when n <= N.
+	void reallocate(std::size_t n)
+	{
+		if (n <= N)
+		{
+			if (is_inline())
+				return;
+			T* old = elements;
+			uninitialized_relocate(old, old + count, inline_data());
+			std::allocator<T>().deallocate(old, reservedSize);
+			elements = inline_data();
+			reservedSize = N;
+			return;
+		}
+
+		T* newElements = std::allocator<T>().allocate(n);
+
+		try
+		{
+			uninitialized_relocate(elements, elements + count, newElements);
+		}
+		catch (...)
+		{
+			std::allocator<T>().deallocate(newElements, n);
+			throw;
+		}
+
+		if (!is_inline())
+			std::allocator<T>().deallocate(elements, reservedSize);
+		elements = newElements;
+		reservedSize = n;
+	}
+};
+
+template <typename T, std::size_t N>
+bool operator== (const small_vector<T, N>& lhs, const small_vector<T, N>& rhs)
+{
+	if (lhs.size() != rhs.size())
+		return false;
+
+	return simd::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T, std::size_t N>
+bool operator!= (const small_vector<T, N>& lhs, const small_vector<T, N>& rhs) { return !(lhs == rhs); }
+
+template <typename T, std::size_t N>
+bool operator< (const small_vector<T, N>& lhs, const small_vector<T, N>& rhs)
+{
+	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, std::size_t N>
+bool operator> (const small_vector<T, N>& lhs, const small_vector<T, N>& rhs) { return rhs < lhs; }
+
+template <typename T, std::size_t N>
+bool operator<= (const small_vector<T, N>& lhs, const small_vector<T, N>& rhs) { return !(rhs < lhs); }
+
+template <typename T, std::size_t N>
+bool operator>= (const small_vector<T, N>& lhs, const small_vector<T, N>& rhs) { return !(lhs < rhs); }
+
+template <typename T, std::size_t N>
+void swap(small_vector<T, N>& lhs, small_vector<T, N>& rhs) { lhs.swap(rhs); }
+
+#endif
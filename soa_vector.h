@@ -0,0 +1,192 @@
+// Structure-of-arrays vector: soa_vector<Ts...> stores field I of every row in its own
+// vector<Ts[I]>, so a loop over one field streams only that field's memory. Rows are accessed
+// as tuples of references, columns as spans.
+#ifndef _SOA_VECTOR_H_
+#define _SOA_VECTOR_H_
+
+#include <cstddef>  // size_t
+#include <iterator> // random_access_iterator_tag
+#include <tuple>    // tuple, get, apply
+#include <type_traits> // conditional
+#include <utility>  // index_sequence
+#include "vector.h"
+#include "span.h"
+
+template <typename... Ts>
+class soa_vector
+{
+	static_assert(sizeof...(Ts) > 0, "soa_vector<>: needs at least one field");
+
+	using columns_type = std::tuple<vector<Ts>...>;
+	using indices = std::index_sequence_for<Ts...>;
+
+	columns_type columns; // All columns always have the same size and capacity.
+
+	// Random access iterator over rows. Dereferencing yields a tuple of references.
+	template <bool Const>
+	class row_iterator
+	{
+		using owner = typename std::conditional<Const, const soa_vector, soa_vector>::type;
+
+		owner* v;
+		std::size_t i;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::tuple<Ts...>;
+		using difference_type = std::ptrdiff_t;
+		using reference = typename std::conditional<Const, std::tuple<const Ts&...>, std::tuple<Ts&...>>::type;
+		using pointer = void;
+
+		row_iterator() noexcept : v(nullptr), i(0) { }
+		row_iterator(owner* o, std::size_t n) noexcept : v(o), i(n) { }
+		template <bool C, typename = typename std::enable_if<Const && !C>::type>
+		row_iterator(const row_iterator<C>& rhs) noexcept : v(rhs.v), i(rhs.i) { }
+
+		reference operator* () const { return (*v)[i]; }
+		reference operator[] (difference_type n) const { return (*v)[i + n]; }
+
+		row_iterator& operator++ () { ++i; return *this; }
+		row_iterator operator++ (int) { row_iterator t(*this); ++i; return t; }
+		row_iterator& operator-- () { --i; return *this; }
+		row_iterator operator-- (int) { row_iterator t(*this); --i; return t; }
+		row_iterator& operator+= (difference_type n) { i += n; return *this; }
+		row_iterator& operator-= (difference_type n) { i -= n; return *this; }
+		row_iterator operator+ (difference_type n) const { return row_iterator(v, i + n); }
+		row_iterator operator- (difference_type n) const { return row_iterator(v, i - n); }
+		friend row_iterator operator+ (difference_type n, const row_iterator& it) { return it + n; }
+		difference_type operator- (const row_iterator& rhs) const { return difference_type(i) - difference_type(rhs.i); }
+
+		bool operator== (const row_iterator& rhs) const { return i == rhs.i; }
+		bool operator!= (const row_iterator& rhs) const { return i != rhs.i; }
+		bool operator< (const row_iterator& rhs) const { return i < rhs.i; }
+		bool operator> (const row_iterator& rhs) const { return i > rhs.i; }
+		bool operator<= (const row_iterator& rhs) const { return i <= rhs.i; }
+		bool operator>= (const row_iterator& rhs) const { return i >= rhs.i; }
+
+		template <bool> friend class row_iterator;
+	};
+
+public:
+	using value_type = std::tuple<Ts...>;
+	using reference = std::tuple<Ts&...>;
+	using const_reference = std::tuple<const Ts&...>;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = row_iterator<false>;
+	using const_iterator = row_iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	template <std::size_t I>
+	using column_type = typename std::tuple_element<I, value_type>::type;
+
+	iterator begin() noexcept { return iterator(this, 0); }
+	iterator end() noexcept { return iterator(this, size()); }
+	const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	const_iterator end() const noexcept { return const_iterator(this, size()); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	void clear() noexcept { for_each_column([](auto& c) { c.clear(); }); }
+
+	void push_back(const value_type& row) { emplace_row(row, indices()); }
+	void push_back(value_type&& row) { emplace_row(std::move(row), indices()); }
+
+	// One argument per field.
+	template <typename... Args>
+	reference emplace_back(Args&&... args)
+	{
+		static_assert(sizeof...(Args) == sizeof...(Ts), "soa_vector<>: emplace_back needs one argument per field");
+		emplace_row(std::forward_as_tuple(std::forward<Args>(args)...), indices());
+		return back();
+	}
+
+	void pop_back()
+	{
+		if (empty())
+			return;
+		for_each_column([](auto& c) { c.pop_back(); });
+	}
+
+	reference operator[] (std::size_t i) { return row(i, indices()); }
+	const_reference operator[] (std::size_t i) const { return row(i, indices()); }
+
+	reference front() { return (*this)[0]; }
+	const_reference front() const { return (*this)[0]; }
+	reference back() { return (*this)[size() - 1]; }
+	const_reference back() const { return (*this)[size() - 1]; }
+
+	// Contiguous view of field I.
+	template <std::size_t I>
+	span<column_type<I>> column() noexcept
+	{
+		auto& c = std::get<I>(columns);
+		return span<column_type<I>>(c.data(), c.size());
+	}
+
+	template <std::size_t I>
+	span<const column_type<I>> column() const noexcept
+	{
+		const auto& c = std::get<I>(columns);
+		return span<const column_type<I>>(c.data(), c.size());
+	}
+
+	std::size_t size() const noexcept { return std::get<0>(columns).size(); }
+	bool empty() const noexcept { return size() == 0; }
+	std::size_t capacity() const noexcept { return std::get<0>(columns).capacity(); }
+
+	void reserve(std::size_t n) { for_each_column([n](auto& c) { c.reserve(n); }); }
+	void resize(std::size_t n) { for_each_column([n](auto& c) { c.resize(n); }); }
+	void shrink_to_fit() { for_each_column([](auto& c) { c.shrink_to_fit(); }); }
+
+	void swap(soa_vector& rhs) noexcept { columns.swap(rhs.columns); }
+
+	friend bool operator== (const soa_vector& lhs, const soa_vector& rhs) { return lhs.columns == rhs.columns; }
+	friend bool operator!= (const soa_vector& lhs, const soa_vector& rhs) { return !(lhs == rhs); }
+
+private:
+	template <typename F>
+	void for_each_column(F f) { std::apply([&f](auto&... c) { (f(c), ...); }, columns); }
+
+	template <std::size_t... I>
+	reference row(std::size_t i, std::index_sequence<I...>) { return reference(std::get<I>(columns)[i]...); }
+
+	template <std::size_t... I>
+	const_reference row(std::size_t i, std::index_sequence<I...>) const { return const_reference(std::get<I>(columns)[i]...); }
+
+	// Grows every column together (doubling) before constructing anything, so appending to
+	// a column cannot reallocate and a throwing field leaves the earlier columns to unwind.
+	// The row is copied out first when growing, as it may refer to elements of this vector.
+	template <typename Tuple, std::size_t... I>
+	void emplace_row(Tuple&& row, std::index_sequence<I...> seq)
+	{
+		if (size() == capacity())
+		{
+			value_type temp(std::forward<Tuple>(row));
+			reserve(capacity() ? capacity() * 2 : 1);
+			return emplace_row(std::move(temp), seq);
+		}
+
+		std::size_t done = 0;
+		try
+		{
+			((std::get<I>(columns).emplace_back(std::get<I>(std::forward<Tuple>(row))), ++done), ...);
+		}
+		catch (...)
+		{
+			std::size_t k = 0;
+			((k++ < done ? std::get<I>(columns).pop_back() : void()), ...);
+			throw;
+		}
+	}
+};
+
+template <typename... Ts>
+void swap(soa_vector<Ts...>& lhs, soa_vector<Ts...>& rhs) noexcept { lhs.swap(rhs); }
+
+#endif
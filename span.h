@@ -0,0 +1,55 @@
+// Non-owning view of a contiguous range, used for columns of soa_vector.
+#ifndef _SPAN_H_
+#define _SPAN_H_
+
+#include <cstddef>     // size_t
+#include <iterator>    // reverse_iterator
+#include <type_traits> // remove_const
+#include "simd_scan.h" // vectorized find, count, min/max, sum
+
+template <typename T>
+class span
+{
+	T* first;
+	std::size_t count;
+
+public:
+	using element_type = T;
+	using value_type = typename std::remove_const<T>::type;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = T * ;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+
+	constexpr span() noexcept : first(nullptr), count(0) { }
+	constexpr span(T* p, std::size_t n) noexcept : first(p), count(n) { }
+
+	// span<T> converts to span<const T>.
+	template <typename U, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+	constexpr span(const span<U>& rhs) noexcept : first(rhs.data()), count(rhs.size()) { }
+
+	constexpr iterator begin() const noexcept { return first; }
+	constexpr iterator end() const noexcept { return first + count; }
+	reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+
+	constexpr T& operator[] (std::size_t i) const { return first[i]; }
+	constexpr T& front() const { return first[0]; }
+	constexpr T& back() const { return first[count - 1]; }
+	constexpr T* data() const noexcept { return first; }
+
+	constexpr std::size_t size() const noexcept { return count; }
+	constexpr bool empty() const noexcept { return count == 0; }
+
+	constexpr span subspan(std::size_t offset, std::size_t n) const { return span(first + offset, n); }
+
+	// Scans, vectorized for arithmetic T (see simd_scan.h).
+	T* find(const value_type& value) const { return const_cast<T*>(simd::find(begin(), end(), value)); }
+	std::size_t count_of(const value_type& value) const { return simd::count(begin(), end(), value); }
+	bool contains(const value_type& value) const { return simd::contains(begin(), end(), value); }
+	T* min_element() const { return const_cast<T*>(simd::min_element(begin(), end())); }
+	T* max_element() const { return const_cast<T*>(simd::max_element(begin(), end())); }
+	simd::sum_type<value_type> sum() const { return simd::sum(begin(), end()); }
+};
+
+#endif
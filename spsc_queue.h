@@ -0,0 +1,109 @@
+// Bounded single-producer single-consumer ring. Exactly one thread may push and one other thread
+// may pop. Head and tail are plain atomic loads and stores on separate cache lines, and each side
+// keeps a cached copy of the other side's index, so it reads the shared one only when the cache
+// says the ring looks full (producer) or empty (consumer). T may be move-only.
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <atomic>  // atomic
+#include <cstddef> // size_t
+#include <memory>  // allocator
+#include <utility> // move, forward
+
+template <typename T>
+class spsc_queue
+{
+	static constexpr std::size_t cacheLine = 64;
+
+	// Written by neither side after construction.
+	alignas(cacheLine) T* slots;
+	std::size_t mask;
+
+	// Producer side.
+	alignas(cacheLine) std::atomic<std::size_t> tail; // Next slot to fill.
+	std::size_t headCache;                           // Producer's last view of head.
+
+	// Consumer side.
+	alignas(cacheLine) std::atomic<std::size_t> head; // Next slot to drain.
+	std::size_t tailCache;                           // Consumer's last view of tail.
+
+public:
+	// Capacity is rounded up to a power of two.
+	explicit spsc_queue(std::size_t capacity) : tail(0), headCache(0), head(0), tailCache(0)
+	{
+		std::size_t n = 1;
+		while (n < capacity)
+			n *= 2;
+		mask = n - 1;
+		slots = std::allocator<T>().allocate(n);
+	}
+
+	spsc_queue(const spsc_queue&) = delete;
+	spsc_queue& operator= (const spsc_queue&) = delete;
+
+	~spsc_queue()
+	{
+		for (std::size_t i = head.load(std::memory_order_relaxed), e = tail.load(std::memory_order_relaxed); i != e; ++i)
+			slots[i & mask].~T();
+		std::allocator<T>().deallocate(slots, mask + 1);
+	}
+
+	std::size_t capacity() const noexcept { return mask + 1; }
+
+	// Approximate unless called from the producer or consumer thread.
+	std::size_t size() const noexcept { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+	bool empty() const noexcept { return size() == 0; }
+
+	// Producer only. Return false when the ring is full.
+	bool push(const T& data) { return emplace(data); }
+	bool push(T&& data) { return emplace(std::move(data)); }
+
+	template <typename... Args>
+	bool emplace(Args&&... args)
+	{
+		std::size_t t = tail.load(std::memory_order_relaxed);
+		if (t - headCache > mask)
+		{
+			headCache = head.load(std::memory_order_acquire);
+			if (t - headCache > mask)
+				return false;
+		}
+		::new (static_cast<void*>(slots + (t & mask))) T(std::forward<Args>(args)...);
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only. Moves the oldest element into result; returns false when the ring is empty.
+	bool pop(T& result)
+	{
+		T* p = front();
+		if (!p)
+			return false;
+		result = std::move(*p);
+		pop();
+		return true;
+	}
+
+	// Consumer only. The oldest element, or null when the ring is empty; stays valid until pop.
+	T* front()
+	{
+		std::size_t h = head.load(std::memory_order_relaxed);
+		if (h == tailCache)
+		{
+			tailCache = tail.load(std::memory_order_acquire);
+			if (h == tailCache)
+				return nullptr;
+		}
+		return slots + (h & mask);
+	}
+
+	// Consumer only. Destroys the element front() returned.
+	void pop()
+	{
+		std::size_t h = head.load(std::memory_order_relaxed);
+		slots[h & mask].~T();
+		head.store(h + 1, std::memory_order_release);
+	}
+};
+
+#endif
@@ -4,25 +4,36 @@
 #include <iostream>  // cout
 #include <memory>    // smart pointer
 #include <exception> // exceptions
+#if (__cplusplus >= 201703L)
+#include <memory_resource> // polymorphic_allocator
+#endif
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class stack 
 {
 protected:
-	template <typename T>
+	template <typename U>
 	struct node
 	{
-		node(T e) { element = e; }
+		node(const U& e) : element(e) { }
 
-		T element;
-		std::shared_ptr<node<T>> next = nullptr;
+		U element;
+		std::shared_ptr<node<U>> next = nullptr;
 	};
 
+	using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node<T>>;
+
 public:
+	using allocator_type = Allocator;
+
+	stack() { }
+	explicit stack(const Allocator& a) : alloc(a) { }
+
+	allocator_type get_allocator() const { return allocator_type(alloc); }
+
 	void push(const T& e)
 	{
-		auto newNode{ std::make_shared<node<T>>(e) };
-		newNode->element = e;
+		auto newNode{ std::allocate_shared<node<T>>(alloc, e) };
 		newNode->next = head;
 		head = newNode;
 	}
@@ -58,6 +69,16 @@ public:
 
 private:
 	std::shared_ptr<node<T>> head = nullptr;
+	node_allocator alloc;
 };
 
+#if (__cplusplus >= 201703L)
+namespace pmr
+{
+	// Stack drawing its nodes from a std::pmr::memory_resource.
+	template <typename T>
+	using stack = ::stack<T, std::pmr::polymorphic_allocator<T>>;
+}
+#endif
+
 #endif
@@ -0,0 +1,308 @@
+// Vector with a fixed capacity of N elements stored inline. It never allocates; growing past N
+// throws std::bad_alloc, and the try_ functions return null instead of throwing.
+#ifndef _STATIC_VECTOR_H_
+#define _STATIC_VECTOR_H_
+
+#include <algorithm>        // move, move_backward, lexicographical_compare
+#include <cstddef>          // size_t
+#include <cstring>          // memcpy
+#include <initializer_list> // initializer_list
+#include <iterator>         // reverse_iterator
+#include <new>              // bad_alloc
+#include <stdexcept>        // out_of_range
+#include <type_traits>      // is_trivially_copyable
+#include <utility>          // move, forward
+#include "simd_scan.h"      // vectorized compare
+
+template <typename T, std::size_t N>
+class static_vector
+{
+	static_assert(N > 0, "static_vector<>: capacity must be non-zero");
+
+	std::size_t count;                              // Number of actually stored objects.
+	alignas(T) unsigned char buffer[N * sizeof(T)]; // Inline storage.
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = T*;
+	using const_iterator = const T*;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	iterator begin() noexcept { return data(); }
+	iterator end() noexcept { return data() + count; }
+	const_iterator begin() const noexcept { return data(); }
+	const_iterator end() const noexcept { return data() + count; }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	static_vector() noexcept : count(0) { }
+
+	explicit static_vector(std::size_t n) : static_vector() { resize(n); }
+	static_vector(std::size_t n, const T& d) : static_vector() { resize(n, d); }
+
+	static_vector(std::initializer_list<T> init) : static_vector()
+	{
+		check(init.size());
+		for (const T& e : init)
+			unchecked_emplace_back(e);
+	}
+
+	// Copy ctor. The delegated ctor has completed, so a throwing copy runs the dtor.
+	static_vector(const static_vector& rhs) : static_vector()
+	{
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			std::memcpy(buffer, rhs.buffer, rhs.count * sizeof(T));
+			count = rhs.count;
+		}
+		else
+			for (const T& e : rhs)
+				unchecked_emplace_back(e);
+	}
+
+	// Move ctor. Elements are moved one by one; rhs keeps its (moved-from) elements.
+	static_vector(static_vector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) : static_vector()
+	{
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			std::memcpy(buffer, rhs.buffer, rhs.count * sizeof(T));
+			count = rhs.count;
+		}
+		else
+			for (T& e : rhs)
+				unchecked_emplace_back(std::move(e));
+	}
+
+	static_vector& operator= (const static_vector& rhs)
+	{
+		if (this != &rhs)
+			assign_from(rhs.begin(), rhs.count);
+		return *this;
+	}
+
+	static_vector& operator= (static_vector&& rhs) noexcept(std::is_nothrow_move_assignable<T>::value && std::is_nothrow_move_constructible<T>::value)
+	{
+		if (this != &rhs)
+			assign_from(std::make_move_iterator(rhs.begin()), rhs.count);
+		return *this;
+	}
+
+	~static_vector() { clear(); }
+
+	void clear() noexcept
+	{
+		if constexpr (std::is_trivially_destructible<T>::value)
+			count = 0;
+		else
+			while (0 < count)
+				data()[--count].~T();
+	}
+
+	void push_back(const T& d) { emplace_back(d); }
+	void push_back(T&& d) { emplace_back(std::move(d)); }
+
+	// Throws std::bad_alloc when full. Elements never move, so args may refer into this vector.
+	template<typename ...Args>
+	T& emplace_back(Args&&... args)
+	{
+		check(count + 1);
+		return unchecked_emplace_back(std::forward<Args>(args)...);
+	}
+
+	// Returns null instead of throwing when full.
+	template<typename ...Args>
+	T* try_emplace_back(Args&&... args)
+	{
+		if (count == N)
+			return nullptr;
+		return &unchecked_emplace_back(std::forward<Args>(args)...);
+	}
+
+	T* try_push_back(const T& d) { return try_emplace_back(d); }
+	T* try_push_back(T&& d) { return try_emplace_back(std::move(d)); }
+
+	// The caller guarantees size() < capacity().
+	template<typename ...Args>
+	T& unchecked_emplace_back(Args&&... args)
+	{
+		T* p = ::new (static_cast<void*>(data() + count)) T(std::forward<Args>(args)...);
+		++count;
+		return *p;
+	}
+
+	void pop_back()
+	{
+		if (count == 0)
+			return;
+		data()[--count].~T();
+	}
+
+	T& operator[] (std::size_t i) { return data()[i]; }
+	const T& operator[] (std::size_t i) const { return data()[i]; }
+
+	T& at(std::size_t i)
+	{
+		if (i >= count)
+			throw std::out_of_range("static_vector<>: index out of range");
+		return data()[i];
+	}
+
+	const T& at(std::size_t i) const
+	{
+		if (i >= count)
+			throw std::out_of_range("static_vector<>: index out of range");
+		return data()[i];
+	}
+
+	T* data() noexcept { return reinterpret_cast<T*>(buffer); }
+	const T* data() const noexcept { return reinterpret_cast<const T*>(buffer); }
+
+	T& front() { return data()[0]; }
+	const T& front() const { return data()[0]; }
+	T& back() { return data()[count - 1]; }
+	const T& back() const { return data()[count - 1]; }
+
+	template<typename ...Args>
+	iterator emplace(const_iterator it, Args&&... args)
+	{
+		std::size_t i = it - cbegin();
+
+		if (i > count)
+			return end();
+
+		check(count + 1);
+
+		if (i == count)
+		{
+			unchecked_emplace_back(std::forward<Args>(args)...);
+			return begin() + i;
+		}
+
+		T temp(std::forward<Args>(args)...);
+		::new (static_cast<void*>(data() + count)) T(std::move(data()[count - 1]));
+		++count;
+		std::move_backward(begin() + i, end() - 2, end() - 1);
+		data()[i] = std::move(temp);
+
+		return begin() + i;
+	}
+
+	iterator insert(const_iterator it, const T& d) { return emplace(it, d); }
+	iterator insert(const_iterator it, T&& d) { return emplace(it, std::move(d)); }
+
+	iterator erase(const_iterator it) { return erase(it, it + 1); }
+
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		std::size_t i = first - cbegin();
+		std::size_t n = last - first;
+
+		if (n == 0 || i >= count)
+			return begin() + i;
+
+		std::move(begin() + i + n, end(), begin() + i);
+		while (n--)
+			data()[--count].~T();
+
+		return begin() + i;
+	}
+
+	void assign(std::size_t n, const T& d)
+	{
+		check(n);
+		T temp(d);
+		clear();
+		while (count < n)
+			unchecked_emplace_back(temp);
+	}
+
+	void resize(std::size_t n)
+	{
+		check(n);
+		while (count > n)
+			data()[--count].~T();
+		while (count < n)
+			unchecked_emplace_back();
+	}
+
+	void resize(std::size_t n, const T& d)
+	{
+		check(n);
+		T temp(d);
+		while (count > n)
+			data()[--count].~T();
+		while (count < n)
+			unchecked_emplace_back(temp);
+	}
+
+	void swap(static_vector& rhs)
+	{
+		static_vector temp(std::move(rhs));
+		rhs = std::move(*this);
+		*this = std::move(temp);
+	}
+
+	std::size_t size() const noexcept { return count; }
+	bool empty() const noexcept { return count == 0; }
+	bool full() const noexcept { return count == N; }
+	static constexpr std::size_t capacity() noexcept { return N; }
+	static constexpr std::size_t max_size() noexcept { return N; }
+
+private:
+	static void check(std::size_t n)
+	{
+		if (n > N)
+			throw std::bad_alloc();
+	}
+
+	// Replaces the contents with n elements read from first.
+	template <typename InputIt>
+	void assign_from(InputIt first, std::size_t n)
+	{
+		std::size_t i = 0;
+		for (; i < n && i < count; ++i, ++first)
+			data()[i] = *first;
+		while (count > n)
+			data()[--count].~T();
+		for (; i < n; ++i, ++first)
+			unchecked_emplace_back(*first);
+	}
+};
+
+template <typename T, std::size_t N>
+bool operator== (const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+{
+	return lhs.size() == rhs.size() && simd::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T, std::size_t N>
+bool operator!= (const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) { return !(lhs == rhs); }
+
+template <typename T, std::size_t N>
+bool operator< (const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+{
+	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, std::size_t N>
+bool operator> (const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) { return rhs < lhs; }
+
+template <typename T, std::size_t N>
+bool operator<= (const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) { return !(rhs < lhs); }
+
+template <typename T, std::size_t N>
+bool operator>= (const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) { return !(lhs < rhs); }
+
+template <typename T, std::size_t N>
+void swap(static_vector<T, N>& lhs, static_vector<T, N>& rhs) { lhs.swap(rhs); }
+
+#endif
@@ -0,0 +1,252 @@
+// Fork-join work-stealing scheduler. Every worker thread owns a work_stealing_deque: tasks it
+// spawns go to the bottom of its own deque and it pops them back LIFO (cache-warm, depth-first),
+// while idle workers steal the oldest (largest) pieces from the top of the others. Tasks spawned
+// from outside the pool enter through a thread_safe_queue injection queue. Idle workers park
+// (park_wait, see wait_strategy.h) until something is spawned.
+// Threads waiting in sync keep running tasks instead of blocking, so sync may be nested.
+#ifndef _TASK_SCHEDULER_H_
+#define _TASK_SCHEDULER_H_
+
+#include <atomic>      // atomic
+#include <cstddef>     // size_t
+#include <exception>   // exception_ptr, current_exception, rethrow_exception
+#include <memory>      // unique_ptr
+#include <thread>      // thread, hardware_concurrency, yield
+#include <type_traits> // decay_t
+#include <utility>     // forward
+#include "lock_free_queue.h"
+#include "vector.h"
+#include "wait_strategy.h"
+#include "work_stealing_deque.h"
+
+class task_scheduler
+{
+public:
+	class group;
+
+private:
+	struct task
+	{
+		group* owner;
+
+		explicit task(group* owner) : owner(owner) { }
+		virtual ~task() { }
+		virtual void run() = 0;
+	};
+
+	template <typename F>
+	struct callable_task final : task
+	{
+		F f;
+
+		template <typename G>
+		callable_task(group* owner, G&& f) : task(owner), f(std::forward<G>(f)) { }
+		void run() override { f(); }
+	};
+
+	struct alignas(64) worker
+	{
+		work_stealing_deque<task*> tasks;
+	};
+
+	// Which scheduler, if any, the calling thread works for.
+	struct context
+	{
+		task_scheduler* scheduler = nullptr;
+		std::size_t index = 0;
+	};
+
+	static context& current()
+	{
+		static thread_local context c;
+		return c;
+	}
+
+	// Worker index of the calling thread, or count for threads outside the pool.
+	std::size_t self() const
+	{
+		const context& c = current();
+		return c.scheduler == this ? c.index : count;
+	}
+
+	void submit(task* t)
+	{
+		std::size_t i = self();
+		if (i < count)
+			workers[i].tasks.push(t);
+		else
+			injection.wait_push(t);
+		work.notify_one();
+	}
+
+	// Own deque first, then the injection queue, then the other workers round-robin.
+	task* find_task(std::size_t i)
+	{
+		task* t;
+		if (i < count && workers[i].tasks.pop(t))
+			return t;
+		if (injection.pop(t))
+			return t;
+		for (std::size_t n = 1; n <= count; ++n)
+		{
+			std::size_t victim = (i + n) % (count + 1);
+			if (victim < count && workers[victim].tasks.steal(t))
+				return t;
+		}
+		return nullptr;
+	}
+
+	// Runs t and signs it off; the owning group may be gone once pending reaches zero.
+	static void execute(task* t)
+	{
+		group* g = t->owner;
+		try
+		{
+			t->run();
+		}
+		catch (...)
+		{
+			g->fail(std::current_exception());
+		}
+		delete t;
+		g->pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	void run_worker(std::size_t i)
+	{
+		current() = context{ this, i };
+		for (;;)
+		{
+			task* t = nullptr;
+			work.wait([&] { t = find_task(i); return t || stopping.load(std::memory_order_acquire); }, wait_detail::clock::time_point::max());
+			if (!t)
+				return;
+			execute(t);
+		}
+	}
+
+	template <typename Index, typename F>
+	void split(group& g, Index first, Index last, const F& f, Index grain)
+	{
+		while (last - first > grain)
+		{
+			Index mid = first + (last - first) / 2;
+			g.spawn([this, &g, &f, mid, last, grain] { split(g, mid, last, f, grain); });
+			last = mid;
+		}
+		for (; first < last; ++first)
+			f(first);
+	}
+
+public:
+	// A set of spawned tasks that can be waited for together. Destruction waits as well.
+	class group
+	{
+		friend class task_scheduler;
+
+		task_scheduler& scheduler;
+		std::atomic<std::size_t> pending{ 0 };
+		std::atomic<bool> failed{ false };
+		std::exception_ptr error;
+
+		void fail(std::exception_ptr e)
+		{
+			bool expected = false;
+			if (failed.compare_exchange_strong(expected, true, std::memory_order_relaxed))
+				error = e;
+		}
+
+		// Runs tasks until every task of this group has finished.
+		void wait()
+		{
+			std::size_t i = scheduler.self();
+			while (pending.load(std::memory_order_acquire) != 0)
+			{
+				if (task* t = scheduler.find_task(i))
+					execute(t);
+				else
+					std::this_thread::yield();
+			}
+		}
+
+	public:
+		explicit group(task_scheduler& scheduler) : scheduler(scheduler) { }
+		group(const group&) = delete;
+		group& operator= (const group&) = delete;
+		~group() { wait(); }
+
+		template <typename F>
+		void spawn(F&& f)
+		{
+			task* t = new callable_task<std::decay_t<F>>(this, std::forward<F>(f));
+			pending.fetch_add(1, std::memory_order_relaxed);
+			scheduler.submit(t);
+		}
+
+		// Waits for every task spawned so far, including tasks they spawned into this group,
+		// then rethrows the first exception one of them threw.
+		void sync()
+		{
+			wait();
+			if (failed.load(std::memory_order_relaxed))
+			{
+				std::exception_ptr e = error;
+				error = nullptr;
+				failed.store(false, std::memory_order_relaxed);
+				std::rethrow_exception(e);
+			}
+		}
+	};
+
+	// threads 0 means one worker per hardware thread.
+	explicit task_scheduler(std::size_t threads = 0, std::size_t injectionCapacity = 1024) : injection(injectionCapacity), stopping(false), root(*this)
+	{
+		if (threads == 0)
+			threads = std::thread::hardware_concurrency();
+		count = threads ? threads : 1;
+
+		workers.reset(new worker[count]);
+		for (std::size_t i = 0; i < count; ++i)
+			threadList.emplace_back([this, i] { run_worker(i); });
+	}
+
+	task_scheduler(const task_scheduler&) = delete;
+	task_scheduler& operator= (const task_scheduler&) = delete;
+
+	// Runs whatever is still queued, then stops the workers.
+	~task_scheduler()
+	{
+		stopping.store(true, std::memory_order_release);
+		work.notify();
+		for (std::thread& t : threadList)
+			t.join();
+	}
+
+	std::size_t thread_count() const { return count; }
+
+	// spawn and sync on the scheduler's own group.
+	template <typename F>
+	void spawn(F&& f) { root.spawn(std::forward<F>(f)); }
+	void sync() { root.sync(); }
+
+	// Calls f(i) for every i in [first, last). The range is halved recursively down to pieces
+	// of at most grain indices, so thieves take large halves and owners work through small ones.
+	template <typename Index, typename F>
+	void parallel_for(Index first, Index last, const F& f, Index grain = 1)
+	{
+		group g(*this);
+		split(g, first, last, f, grain < Index(1) ? Index(1) : grain);
+		g.sync();
+	}
+
+private:
+	std::unique_ptr<worker[]> workers;
+	std::size_t count;
+	vector<std::thread> threadList;
+	thread_safe_queue<task*> injection;
+	park_wait work;
+	std::atomic<bool> stopping;
+	group root; // Last: its destructor may still run tasks.
+};
+
+#endif
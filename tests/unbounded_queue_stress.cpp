@@ -0,0 +1,100 @@
+// Multi-producer multi-consumer stress test for unbounded_queue, meant to run under
+// ThreadSanitizer (and, separately, AddressSanitizer):
+//   g++ -std=c++17 -O1 -g -fsanitize=thread -I.. -pthread unbounded_queue_stress.cpp -o unbounded_queue_stress
+//   g++ -std=c++17 -O1 -g -fsanitize=address,undefined -I.. -pthread unbounded_queue_stress.cpp -o unbounded_queue_stress
+// Small segments make producers close and append segments, and consumers retire them,
+// thousands of times. Every element must arrive exactly once, and each consumer must see
+// every producer's elements in the order they were pushed. Exits non-zero on failure.
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "unbounded_queue.h"
+
+#define CHECK(x) do { if (!(x)) { std::printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #x); std::exit(1); } } while (0)
+
+namespace
+{
+	const unsigned producers = 4;
+	const unsigned consumers = 4;
+	const unsigned perProducer = 100000;
+
+	struct item
+	{
+		unsigned producer;
+		unsigned seq;
+	};
+
+	// Move-only, heap-owning elements, so a lost or doubly destroyed element shows up as a
+	// leak or a double free under AddressSanitizer.
+	using element = std::unique_ptr<item>;
+
+	void stress()
+	{
+		unbounded_queue<element, 8> q;
+		std::atomic<unsigned> popped{ 0 };
+		std::vector<std::atomic<unsigned>> seen(producers * perProducer);
+		std::vector<std::thread> threads;
+
+		for (unsigned p = 0; p < producers; ++p)
+			threads.emplace_back([&q, p]
+			{
+				for (unsigned i = 0; i < perProducer; ++i)
+					q.push(element(new item{ p, i }));
+			});
+
+		for (unsigned c = 0; c < consumers; ++c)
+			threads.emplace_back([&]
+			{
+				std::vector<long> last(producers, -1);
+				element e;
+				while (popped.load(std::memory_order_relaxed) < producers * perProducer)
+				{
+					if (!q.pop(e))
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					CHECK(e->producer < producers && e->seq < perProducer);
+					CHECK(long(e->seq) > last[e->producer]);
+					last[e->producer] = e->seq;
+					seen[e->producer * perProducer + e->seq].fetch_add(1, std::memory_order_relaxed);
+					popped.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+
+		for (std::thread& t : threads)
+			t.join();
+
+		element e;
+		CHECK(!q.pop(e) && q.empty());
+		for (std::atomic<unsigned>& n : seen)
+			CHECK(n.load() == 1);
+	}
+
+	// Elements still queued when the queue is destroyed must be destroyed with it.
+	void leftovers()
+	{
+		unbounded_queue<element, 4> q;
+		std::thread t([&q]
+		{
+			for (unsigned i = 0; i < 1000; ++i)
+				q.emplace(new item{ 0, i });
+		});
+		element e;
+		for (unsigned i = 0; i < 500; )
+			if (q.pop(e))
+				CHECK(e->seq == i++);
+		t.join();
+	}
+}
+
+int main()
+{
+	stress();
+	leftovers();
+	std::puts("ok");
+	return 0;
+}
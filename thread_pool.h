@@ -0,0 +1,318 @@
+// Fixed-size thread pool. Work goes through one thread_safe_queue<small_task> (lock_free_queue.h)
+// whose waits park on a futex (park_wait, wait_strategy.h), so idle workers sleep and a full
+// queue blocks the submitter instead of dropping work.
+// small_task is a move-only void() callable that stores callables of up to inline_size bytes
+// in place; posting such a lambda does not allocate. submit returns a std::future (its shared
+// state is allocated by std::packaged_task). An exception escaping a posted task terminates
+// the program, as with std::thread; submit delivers it through the future instead.
+// Shutdown is graceful: queued tasks, and tasks they post, all run before the workers stop.
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <atomic>      // atomic
+#include <cstddef>     // size_t, max_align_t
+#include <future>      // future, packaged_task
+#include <iterator>    // distance, advance
+#include <new>         // placement new
+#include <stdexcept>   // runtime_error
+#include <thread>      // thread, hardware_concurrency
+#include <type_traits> // decay_t, invoke_result_t, enable_if_t
+#include <utility>     // move, forward
+#include "lock_free_queue.h"
+#include "vector.h"
+#include "wait_strategy.h"
+
+#if defined(__linux__)
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h>   // cpu_set_t
+#endif
+
+class small_task
+{
+public:
+	static constexpr std::size_t inline_size = 48;
+
+	small_task() noexcept : ops(nullptr) { }
+
+	template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, small_task>::value>>
+	small_task(F&& f) noexcept(fits<std::decay_t<F>> && std::is_nothrow_constructible<std::decay_t<F>, F&&>::value)
+	{
+		using Fn = std::decay_t<F>;
+		if constexpr (fits<Fn>)
+		{
+			new (storage) Fn(std::forward<F>(f));
+			ops = &inline_ops<Fn>::table;
+		}
+		else
+		{
+			*reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(f));
+			ops = &heap_ops<Fn>::table;
+		}
+	}
+
+	small_task(small_task&& other) noexcept : ops(other.ops)
+	{
+		if (ops)
+			ops->move(other.storage, storage);
+		other.ops = nullptr;
+	}
+
+	small_task& operator= (small_task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			ops = other.ops;
+			if (ops)
+				ops->move(other.storage, storage);
+			other.ops = nullptr;
+		}
+		return *this;
+	}
+
+	~small_task() { reset(); }
+
+	explicit operator bool() const noexcept { return ops != nullptr; }
+
+	// False when the callable lives on the heap.
+	bool is_inline() const noexcept { return ops && ops->inlined; }
+
+	void operator()() { ops->invoke(storage); }
+
+	void reset() noexcept
+	{
+		if (ops)
+			ops->destroy(storage);
+		ops = nullptr;
+	}
+
+private:
+	struct operations
+	{
+		void (*invoke)(void*);
+		void (*move)(void* from, void* to);
+		void (*destroy)(void*);
+		bool inlined;
+	};
+
+	template <typename F>
+	static constexpr bool fits = sizeof(F) <= inline_size && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<F>::value;
+
+	template <typename F>
+	struct inline_ops
+	{
+		static void invoke(void* p) { (*static_cast<F*>(p))(); }
+		static void move(void* from, void* to)
+		{
+			new (to) F(std::move(*static_cast<F*>(from)));
+			static_cast<F*>(from)->~F();
+		}
+		static void destroy(void* p) { static_cast<F*>(p)->~F(); }
+		static constexpr operations table{ invoke, move, destroy, true };
+	};
+
+	template <typename F>
+	struct heap_ops
+	{
+		static void invoke(void* p) { (**static_cast<F**>(p))(); }
+		static void move(void* from, void* to) { *static_cast<F**>(to) = *static_cast<F**>(from); }
+		static void destroy(void* p) { delete *static_cast<F**>(p); }
+		static constexpr operations table{ invoke, move, destroy, false };
+	};
+
+	alignas(std::max_align_t) unsigned char storage[inline_size];
+	const operations* ops;
+};
+
+class thread_pool
+{
+	using queue_type = thread_safe_queue<small_task, false, park_wait>;
+
+	queue_type queue;
+	vector<std::thread> threadList;
+	std::atomic<std::size_t> pending;  // Admitted and not yet finished.
+	std::atomic<bool> closed;
+	park_wait idle;                    // Drainers waiting for pending to reach zero.
+
+	// The pool whose worker the calling thread is, if any.
+	static const thread_pool*& current()
+	{
+		static thread_local const thread_pool* pool = nullptr;
+		return pool;
+	}
+
+	// An empty small_task tells the worker that pops it to exit.
+	void run_worker()
+	{
+		current() = this;
+		small_task t;
+		for (;;)
+		{
+			queue.wait_pop(t);
+			if (!t)
+				return;
+			t();
+			t.reset();
+			release(1);
+		}
+	}
+
+	// Counts n more tasks as pending before they are queued; throws once shutdown has begun.
+	// Both sides use seq_cst, so either this sees closed or shutdown sees the new count and
+	// waits for the tasks. Tasks running on this pool may still post during shutdown: their
+	// own pending count keeps shutdown waiting until the follow-up work is done.
+	void admit(std::size_t n)
+	{
+		pending.fetch_add(n, std::memory_order_seq_cst);
+		if (closed.load(std::memory_order_seq_cst) && current() != this)
+		{
+			release(n);
+			throw std::runtime_error("thread_pool: post after shutdown");
+		}
+	}
+
+	void release(std::size_t n)
+	{
+		if (pending.fetch_sub(n, std::memory_order_acq_rel) == n)
+			idle.notify();
+	}
+
+	// Queues an admitted task. A worker of this pool never blocks on a full queue (every worker
+	// could end up waiting for the others); it runs the task itself instead.
+	void enqueue(small_task&& t)
+	{
+		if (current() != this)
+			queue.wait_push(std::move(t));
+		else if (!queue.push(std::move(t)))
+		{
+			t();
+			release(1);
+		}
+	}
+
+	void wait_idle()
+	{
+		idle.wait([&] { return pending.load(std::memory_order_seq_cst) == 0; }, wait_detail::clock::time_point::max());
+	}
+
+public:
+	// threads 0 means one worker per hardware thread. With pin, worker i is bound to CPU
+	// i modulo the hardware thread count.
+	explicit thread_pool(std::size_t threads = 0, std::size_t queueCapacity = 1024, bool pin = false) : queue(queueCapacity), pending(0), closed(false)
+	{
+		std::size_t cpus = std::thread::hardware_concurrency();
+		if (threads == 0)
+			threads = cpus ? cpus : 1;
+
+		threadList.reserve(threads);
+		for (std::size_t i = 0; i < threads; ++i)
+		{
+			threadList.emplace_back([this] { run_worker(); });
+			if (pin && cpus)
+				set_affinity(i, i % cpus);
+		}
+	}
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator= (const thread_pool&) = delete;
+
+	~thread_pool() { shutdown(); }
+
+	std::size_t thread_count() const { return threadList.size(); }
+
+	// Tasks posted and not yet finished.
+	std::size_t pending_count() const { return pending.load(std::memory_order_relaxed); }
+
+	// Binds worker i to one CPU; false where unsupported or when the system refuses.
+	bool set_affinity(std::size_t worker, std::size_t cpu)
+	{
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		return pthread_setaffinity_np(threadList[worker].native_handle(), sizeof(set), &set) == 0;
+#else
+		(void)worker;
+		(void)cpu;
+		return false;
+#endif
+	}
+
+	// Fire and forget; blocks while the queue is full. Throws std::runtime_error after shutdown.
+	template <typename F>
+	void post(F&& f)
+	{
+		small_task t(std::forward<F>(f));
+		admit(1);
+		enqueue(std::move(t));
+	}
+
+	// Like post, but returns false instead of blocking when the queue is full.
+	template <typename F>
+	bool try_post(F&& f)
+	{
+		small_task t(std::forward<F>(f));
+		admit(1);
+		if (queue.push(std::move(t)))
+			return true;
+		release(1);
+		return false;
+	}
+
+	// Posts f and returns a future for its result (or exception).
+	template <typename F>
+	std::future<std::invoke_result_t<std::decay_t<F>&>> submit(F&& f)
+	{
+		using R = std::invoke_result_t<std::decay_t<F>&>;
+		std::packaged_task<R()> task(std::forward<F>(f));
+		std::future<R> result = task.get_future();
+		post(std::move(task));
+		return result;
+	}
+
+	// Posts a copy of every callable in [first, last), claiming runs of queue slots with one
+	// CAS each (push_bulk); blocks while the queue is full. Callables whose small_task cannot
+	// be built without throwing (heap-stored ones) are posted one by one.
+	template <typename ForwardIt>
+	void post_bulk(ForwardIt first, ForwardIt last)
+	{
+		if constexpr (!std::is_nothrow_constructible<small_task, typename std::iterator_traits<ForwardIt>::reference>::value)
+		{
+			for (; first != last; ++first)
+				post(*first);
+			return;
+		}
+
+		admit(static_cast<std::size_t>(std::distance(first, last)));
+		while (first != last)
+		{
+			std::size_t n = queue.push_bulk(first, last);
+			std::advance(first, n);
+			if (n == 0)
+			{
+				enqueue(small_task(*first));
+				++first;
+			}
+		}
+	}
+
+	// Waits until every task posted so far has finished. Must not be called from a worker.
+	void drain() { wait_idle(); }
+
+	// Stops accepting work from outside the pool, waits until everything queued has run
+	// (including work those tasks post), then stops and joins the workers. Must not be called
+	// from a worker.
+	void shutdown()
+	{
+		bool expected = false;
+		if (!closed.compare_exchange_strong(expected, true, std::memory_order_seq_cst))
+			return;
+		wait_idle();
+		for (std::size_t i = 0; i < threadList.size(); ++i)
+			queue.wait_push(small_task());
+		for (std::thread& t : threadList)
+			t.join();
+	}
+};
+
+#endif
@@ -0,0 +1,225 @@
+// Unbounded multi-producer multi-consumer FIFO queue: a linked list of ring segments, each
+// using the slot/sequence scheme of thread_safe_queue (lock_free_queue.h). A producer that
+// finds its segment full closes it (a flag bit in the segment's tail counter, so no later
+// push can land there and overtake the elements in the next segment), appends a fresh
+// segment with one CAS and continues there. Consumers move to the next segment once the
+// closed one is drained; the drained segment is freed through hazard pointers
+// (hazard_pointer.h), so a thread still working in it never touches freed memory.
+// push never fails (short of bad_alloc); memory grows by one segment per SegmentSize elements.
+#ifndef _UNBOUNDED_QUEUE_H_
+#define _UNBOUNDED_QUEUE_H_
+
+#include <atomic>      // atomic
+#include <cstddef>     // size_t
+#include <type_traits> // is_nothrow_constructible, is_nothrow_move_assignable
+#include <utility>     // move, forward
+#include "hazard_pointer.h"
+
+template <typename T, std::size_t SegmentSize = 1024>
+class unbounded_queue
+{
+	static_assert(SegmentSize >= 2 && (SegmentSize & (SegmentSize - 1)) == 0, "SegmentSize must be a power of two");
+	// A claimed slot must be released, so moving the element out of it must not throw.
+	static_assert(std::is_nothrow_move_assignable<T>::value, "unbounded_queue needs a T that is nothrow move assignable");
+
+	static constexpr std::size_t cacheLine = 64;
+	static constexpr std::size_t mask = SegmentSize - 1;
+	static constexpr std::size_t closed = std::size_t(1) << (sizeof(std::size_t) * 8 - 1);
+
+	// data is constructed by push and destroyed by pop only.
+	struct Node
+	{
+		Node() : tail(0), head(std::size_t(-1)) { }
+		~Node() { }
+
+		union { T data; };
+		std::atomic<std::size_t> tail;
+		std::atomic<std::size_t> head;
+	};
+
+	struct Segment
+	{
+		alignas(cacheLine) std::atomic<std::size_t> tail; // Next ticket; top bit set once closed.
+		alignas(cacheLine) std::atomic<std::size_t> head;
+		alignas(cacheLine) std::atomic<Segment*> next;
+		Node slots[SegmentSize];
+
+		Segment() : tail(0), head(0), next(nullptr)
+		{
+			for (std::size_t i = 0; i < SegmentSize; ++i)
+				slots[i].tail.store(i, std::memory_order_relaxed);
+		}
+
+		// False once the segment is closed; closes it when it is full. The construction must not
+		// throw: a claimed slot that is never published would stall the consumers forever.
+		template <typename... Args>
+		bool emplace(Args&&... args)
+		{
+			Node* node;
+			std::size_t t = tail.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				if (t & closed)
+					return false;
+				node = &slots[t & mask];
+				if (node->tail.load(std::memory_order_acquire) != t)
+				{
+					// Full, unless t is stale; the CAS only closes the segment if it is not.
+					if (tail.compare_exchange_weak(t, t | closed, std::memory_order_relaxed))
+						return false;
+					continue;
+				}
+				if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed))
+					break;
+			}
+			new (&node->data)T(std::forward<Args>(args)...);
+			node->head.store(t, std::memory_order_release);
+			return true;
+		}
+
+		bool pop(T& result)
+		{
+			Node* node;
+			std::size_t h = head.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				node = &slots[h & mask];
+				if (node->head.load(std::memory_order_acquire) != h)
+					return false;
+				if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed))
+					break;
+			}
+			result = std::move(node->data);
+			(&node->data)->~T();
+			node->tail.store(h + SegmentSize, std::memory_order_release);
+			return true;
+		}
+
+		// Closed, and every ticket handed out has been taken by a consumer: nothing can
+		// appear here any more.
+		bool drained() const
+		{
+			std::size_t t = tail.load(std::memory_order_acquire);
+			return (t & closed) && head.load(std::memory_order_acquire) == (t & ~closed);
+		}
+	};
+
+	alignas(cacheLine) std::atomic<Segment*> _head; // Segment consumers pop from.
+	alignas(cacheLine) std::atomic<Segment*> _tail; // Segment producers push to; never behind _head.
+
+	// Pushes into the tail segment, appending a segment when it is full; the construction must
+	// not throw.
+	template <typename... Args>
+	void construct(Args&&... args)
+	{
+		for (;;)
+		{
+			Segment* s = hazard::protect(_tail);
+			if (s->emplace(std::forward<Args>(args)...))
+				break;
+
+			Segment* next = s->next.load(std::memory_order_acquire);
+			if (!next)
+			{
+				Segment* fresh = new Segment;
+				if (s->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+					next = fresh;
+				else
+					delete fresh;
+			}
+			advance_tail(s, next);
+		}
+		hazard::clear();
+	}
+
+	// Moves _tail off s (to s->next) if it still points there.
+	void advance_tail(Segment* s, Segment* next)
+	{
+		_tail.compare_exchange_strong(s, next, std::memory_order_release, std::memory_order_relaxed);
+	}
+
+public:
+	unbounded_queue()
+	{
+		Segment* s = new Segment;
+		_head.store(s, std::memory_order_relaxed);
+		_tail.store(s, std::memory_order_relaxed);
+	}
+
+	unbounded_queue(const unbounded_queue&) = delete;
+	unbounded_queue& operator= (const unbounded_queue&) = delete;
+
+	// No other thread may use the queue any more.
+	~unbounded_queue()
+	{
+		for (Segment* s = _head.load(std::memory_order_relaxed); s; )
+		{
+			std::size_t t = s->tail.load(std::memory_order_relaxed) & ~closed;
+			for (std::size_t i = s->head.load(std::memory_order_relaxed); i != t; ++i)
+				(&s->slots[i & mask].data)->~T();
+			Segment* next = s->next.load(std::memory_order_relaxed);
+			delete s;
+			s = next;
+		}
+	}
+
+	static constexpr std::size_t segment_size() { return SegmentSize; }
+
+	void push(const T& data) { emplace(data); }
+	void push(T&& data) { emplace(std::move(data)); }
+
+	// T is only built in place when that cannot throw; otherwise it is built first and moved in.
+	template <typename... Args>
+	void emplace(Args&&... args)
+	{
+		if constexpr (std::is_nothrow_constructible<T, Args&&...>::value)
+			construct(std::forward<Args>(args)...);
+		else
+		{
+			static_assert(std::is_nothrow_move_constructible<T>::value, "unbounded_queue needs a T that is nothrow move constructible");
+			T element(std::forward<Args>(args)...);
+			construct(std::move(element));
+		}
+	}
+
+	// Moves the oldest element into result; returns false when the queue is empty.
+	bool pop(T& result)
+	{
+		for (;;)
+		{
+			Segment* s = hazard::protect(_head);
+			if (s->pop(result))
+			{
+				hazard::clear();
+				return true;
+			}
+
+			// next is only set after s was closed; a producer that claimed a ticket before the
+			// close may still be filling it, so drained() must hold as well.
+			Segment* next = s->next.load(std::memory_order_acquire);
+			if (!next || !s->drained())
+			{
+				hazard::clear();
+				return false;
+			}
+			if (_head.compare_exchange_strong(s, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				advance_tail(s, next);
+				hazard::clear();
+				hazard::retire(s);
+			}
+		}
+	}
+
+	// Approximate while other threads push or pop.
+	bool empty() const
+	{
+		Segment* s = hazard::protect(_head);
+		bool result = s->head.load(std::memory_order_acquire) == (s->tail.load(std::memory_order_acquire) & ~closed)
+			&& s->next.load(std::memory_order_acquire) == nullptr;
+		hazard::clear();
+		return result;
+	}
+};
+
+#endif
@@ -1,87 +1,198 @@
 #ifndef _VECTOR_H_
 #define _VECTOR_H_
 
-#include <memory>    // unique pointer
-#include <algorithm> // min
-#include <limits>    // numeric_limits
+#include <memory>          // allocator, allocator_traits
+#include <algorithm>       // min, move_backward
+#include <limits>          // numeric_limits
+#include <cstring>         // memcpy, memmove
+#include <iterator>        // reverse_iterator
+#include <type_traits>     // is_trivially_copyable
+#include <utility>         // move, forward
+#include <memory_resource> // polymorphic_allocator
+#include "simd_scan.h"     // vectorized find, count, min/max, sum, compare
+
+// Moves [first, last) into uninitialized dest and destroys the source. Trivially copyable
+// types are relocated with a single memcpy, others are moved when that cannot throw and
+// copied otherwise, so a throwing copy leaves the source intact.
+template <typename Alloc, typename T>
+void uninitialized_relocate(Alloc& alloc, T* first, T* last, T* dest)
+{
+	using traits = std::allocator_traits<Alloc>;
+
+	if constexpr (std::is_trivially_copyable<T>::value)
+	{
+		if (first != last)
+			std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(T));
+	}
+	else
+	{
+		T* out = dest;
+		try
+		{
+			for (T* p = first; p != last; ++p, ++out)
+				traits::construct(alloc, out, std::move_if_noexcept(*p));
+		}
+		catch (...)
+		{
+			for (; dest != out; ++dest)
+				traits::destroy(alloc, dest);
+			throw;
+		}
+		for (; first != last; ++first)
+			traits::destroy(alloc, first);
+	}
+}
 
 template <typename T>
+void uninitialized_relocate(T* first, T* last, T* dest)
+{
+	std::allocator<T> alloc;
+	uninitialized_relocate(alloc, first, last, dest);
+}
+
+// Allocators may provide bool resize_in_place(T* p, size_t n, size_t newN) noexcept, which grows
+// or shrinks the block p of n elements to newN without moving it (see large_vector.h).
+template <typename Alloc, typename = void>
+struct has_resize_in_place : std::false_type { };
+
+template <typename Alloc>
+struct has_resize_in_place<Alloc, std::void_t<decltype(std::declval<Alloc&>().resize_in_place(
+	std::declval<typename std::allocator_traits<Alloc>::pointer>(), std::size_t(), std::size_t()))>> : std::true_type { };
+
+template <typename T, typename Allocator = std::allocator<T>>
 class vector
 {
-	std::size_t count;             // Number of actually stored objects.
-	std::size_t reservedSize;      // Allocated reservedSize.
-	std::unique_ptr<T[]> elements; // Data elements.
+	using alloc_traits = std::allocator_traits<Allocator>;
+	static_assert(std::is_same<typename alloc_traits::pointer, T*>::value, "vector<>: allocator must use raw pointers");
+
+	std::size_t count;        // Number of actually stored objects.
+	std::size_t reservedSize; // Allocated reservedSize.
+	T* elements;              // Raw, uninitialized storage. Only [0, count) is constructed.
+	Allocator alloc;          // Supplies storage and constructs elements.
 
 public:
+	using value_type = T;
+	using allocator_type = Allocator;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
 	using iterator = T * ;
 	using const_iterator = const T*;
 	using reverse_iterator = std::reverse_iterator<iterator>;
 	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-	typename vector<T>::iterator begin() noexcept { return elements.get(); }
-	typename vector<T>::iterator end() noexcept { return iterator(begin() + count); }
-	typename vector<T>::const_iterator cbegin() const noexcept { return begin(); }
-	typename vector<T>::const_iterator cend() const noexcept { return end(); }
-	typename vector<T>::reverse_iterator rbegin() noexcept { return reverse_iterator(begin() + count); }
-	typename vector<T>::reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
-	typename vector<T>::const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(begin() + count); }
-	typename vector<T>::const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
-
-	template<typename T> friend bool operator== (const vector<T>&, const vector<T>&);
-	template<typename T> friend bool operator!= (const vector<T>&, const vector<T>&);
-	template<typename T> friend bool operator< (const vector<T>&, const vector<T>&);
-	template<typename T> friend bool operator<= (const vector<T>&, const vector<T>&);
-	template<typename T> friend bool operator> (const vector<T>&, const vector<T>&);
-	template<typename T> friend bool operator>= (const vector<T>&, const vector<T>&);
-	template<typename T> friend void swap(vector<T>&, vector<T>&);
-
-	vector() : count(0), reservedSize(0), elements(nullptr) { }
+	typename vector<T, Allocator>::iterator begin() noexcept { return elements; }
+	typename vector<T, Allocator>::iterator end() noexcept { return iterator(begin() + count); }
+	typename vector<T, Allocator>::const_iterator begin() const noexcept { return elements; }
+	typename vector<T, Allocator>::const_iterator end() const noexcept { return const_iterator(begin() + count); }
+	typename vector<T, Allocator>::const_iterator cbegin() const noexcept { return begin(); }
+	typename vector<T, Allocator>::const_iterator cend() const noexcept { return end(); }
+	typename vector<T, Allocator>::reverse_iterator rbegin() noexcept { return reverse_iterator(begin() + count); }
+	typename vector<T, Allocator>::reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	typename vector<T, Allocator>::const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(begin() + count); }
+	typename vector<T, Allocator>::const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	template<typename U, typename A> friend bool operator== (const vector<U, A>&, const vector<U, A>&);
+	template<typename U, typename A> friend bool operator!= (const vector<U, A>&, const vector<U, A>&);
+	template<typename U, typename A> friend bool operator< (const vector<U, A>&, const vector<U, A>&);
+	template<typename U, typename A> friend bool operator<= (const vector<U, A>&, const vector<U, A>&);
+	template<typename U, typename A> friend bool operator> (const vector<U, A>&, const vector<U, A>&);
+	template<typename U, typename A> friend bool operator>= (const vector<U, A>&, const vector<U, A>&);
+	template<typename U, typename A> friend void swap(vector<U, A>&, vector<U, A>&);
+
+	vector() noexcept(noexcept(Allocator())) : count(0), reservedSize(0), elements(nullptr), alloc() { }
+	explicit vector(const Allocator& a) noexcept : count(0), reservedSize(0), elements(nullptr), alloc(a) { }
 
 	// Copy ctor.
-	vector(vector const &rhs) : count(rhs.count), reservedSize(rhs.reservedSize)
+	vector(vector const &rhs) : vector(rhs, alloc_traits::select_on_container_copy_construction(rhs.alloc)) { }
+
+	vector(vector const &rhs, const Allocator& a) : count(0), reservedSize(0), elements(nullptr), alloc(a)
 	{
-		std::unique_ptr<T[]> elements = std::make_unique<T[]>(reservedSize);
-		std::copy(rhs.begin(), (rhs.begin() + count), begin());
+		copy_from(rhs);
 	}
 
 	// Move ctor.
-	vector(vector&& rhs) noexcept { swap(rhs); }
+	vector(vector&& rhs) noexcept : count(0), reservedSize(0), elements(nullptr), alloc(std::move(rhs.alloc)) { steal(rhs); }
 
 	// Assignment ctor.
-	vector<T>& operator= (const vector& rhs)
+	vector<T, Allocator>& operator= (const vector& rhs)
 	{
-		swap(vector(rhs));
+		if (this == &rhs)
+			return *this;
+
+		clear();
+		if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+		{
+			if (alloc != rhs.alloc)
+				release();
+			alloc = rhs.alloc;
+		}
+		copy_from(rhs);
+
 		return *this;
 	}
 
-	// Move assignment ctor.
-	vector<T>& operator= (vector<T>&& rhs)
+	// Move assignment ctor. Storage is stolen unless the allocators differ and do not propagate.
+	vector<T, Allocator>& operator= (vector<T, Allocator>&& rhs)
+		noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
 	{
-		swap(rhs);
+		if (this == &rhs)
+			return *this;
+
+		clear();
+		if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+		{
+			release();
+			alloc = std::move(rhs.alloc);
+			steal(rhs);
+		}
+		else if (alloc == rhs.alloc)
+		{
+			release();
+			steal(rhs);
+		}
+		else
+		{
+			reserve(rhs.count);
+			for (; count < rhs.count; count++)
+				construct(elements + count, std::move(rhs.elements[count]));
+			rhs.clear();
+		}
+
 		return *this;
 	}
 
-	~vector() { clear(); }
+	~vector()
+	{
+		clear();
+		deallocate(elements, reservedSize);
+	}
 
-	void clear() 
-	{ 
+	allocator_type get_allocator() const noexcept { return alloc; }
+
+	// Destroys all elements, capacity is retained.
+	void clear() noexcept
+	{
 		while (0 < count)
-			elements[--count].~T();
-		reservedSize = 0;
+			destroy(elements + --count);
 	}
 
-	void push_back(T const &d)
+	void push_back(T const &d) { emplace_back(d); }
+	void push_back(T&& d) { emplace_back(std::move(d)); }
+
+	template<typename ...Args>
+	T& emplace_back(Args&&... args)
 	{
 		if (reservedSize == count)
-			resize();
-		elements[count++] = d;
+			return grow_emplace_back(std::forward<Args>(args)...);
+		construct(elements + count, std::forward<Args>(args)...);
+		return elements[count++];
 	}
 
 	void pop_back()
 	{
 		if (count == 0)
 			return;
-		count--;
+		destroy(elements + --count);
 	}
 
 	T const &operator[] (size_t i) const { return elements[i]; }
@@ -90,47 +201,154 @@ public:
 	T const & at(size_t i) const { return elements[i]; }
 	T& at(size_t i) { return elements[i]; }
 
-	T* data() noexcept { return elements.get(); }
+	T* data() noexcept { return elements; }
 	const T* data() const noexcept { return elements; }
 
 	T& front() const { return elements[0]; }
 	T& back() const { return elements[count - 1]; }
 
-	void insert(const iterator it, const T& d)
+	// Constructs element in place before it. Args are consumed before any reallocation,
+	// so they may safely refer to elements of this vector.
+	template<typename ...Args>
+	iterator emplace(const_iterator it, Args&&... args)
 	{
-		size_t i = it - begin();
+		size_t i = it - cbegin();
 
 		if (i > count)
-			return;
+			return end();
 
-		if (reservedSize == count)
-			resize();
+		if (i == count)
+		{
+			emplace_back(std::forward<Args>(args)...);
+			return begin() + i;
+		}
+
+		T temp(std::forward<Args>(args)...);
 
-		std::copy((begin() + i), end(), (begin() + i + 1));
-		elements[i] = d;
+		if (reservedSize == count)
+			reallocate(next_capacity());
+
+		if constexpr (std::is_trivially_copyable<T>::value)
+			std::memmove(static_cast<void*>(elements + i + 1), static_cast<const void*>(elements + i), (count - i) * sizeof(T));
+		else
+		{
+			construct(elements + count, std::move(elements[count - 1]));
+			std::move_backward((begin() + i), (end() - 1), end());
+		}
+		elements[i] = std::move(temp);
 		count++;
+
+		return begin() + i;
 	}
 
-	void erase(const iterator it)
+	iterator insert(const_iterator it, const T& d) { return emplace(it, d); }
+	iterator insert(const_iterator it, T&& d) { return emplace(it, std::move(d)); }
+
+	// Inserts [first, last) before it. Forward ranges reserve at most once; the range
+	// must not point into this vector unless a reallocation is guaranteed.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	iterator insert(const_iterator it, InputIt first, InputIt last)
 	{
-		size_t pos = it - begin();
+		size_t i = it - cbegin();
 
-		if (pos >= count)
-			return;
+		if (i > count)
+			return end();
+
+		using category = typename std::iterator_traits<InputIt>::iterator_category;
+		if constexpr (!std::is_base_of<std::forward_iterator_tag, category>::value)
+		{
+			for (size_t j = i; first != last; ++first)
+				emplace(cbegin() + j++, *first);
+			return begin() + i;
+		}
+		else
+		{
+			size_t n = std::distance(first, last);
+
+			if (n == 0)
+				return begin() + i;
+
+			if (count + n > reservedSize)
+				insert_reallocate(i, n, first, last);
+			else
+				insert_in_place(i, n, first, last);
+
+			return begin() + i;
+		}
+	}
+
+	// Appends [first, last), growing at most once for forward ranges.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	void append(InputIt first, InputIt last) { insert(cend(), first, last); }
+
+	iterator erase(const_iterator it) { return erase(it, it + 1); }
+
+	// Erase [first, last).
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		size_t pos = first - cbegin();
+		size_t n = last - first;
 
-		if (pos != count - 1)
-			std::copy((begin() + pos + 1), end(), (begin() + pos));
-		--count;
+		if (pos >= count || n == 0)
+			return begin() + pos;
+
+		if constexpr (std::is_trivially_copyable<T>::value)
+			std::memmove(static_cast<void*>(elements + pos), static_cast<const void*>(elements + pos + n), (count - pos - n) * sizeof(T));
+		else
+			std::move((begin() + pos + n), end(), (begin() + pos));
+		while (n--)
+			destroy(elements + --count);
+
+		return begin() + pos;
 	}
 
+	// Replaces the contents with n copies of d.
 	void assign(const size_t n, const T& d)
 	{
-		for (size_t i = 0; i < n; i++)
-			push_back(d);
+		if (n > reservedSize)
+		{
+			T temp(d);
+			clear();
+			reallocate(n);
+			for (; count < n; count++)
+				construct(elements + count, temp);
+			return;
+		}
+		std::fill_n(begin(), std::min(n, count), d);
+		while (count > n)
+			destroy(elements + --count);
+		for (; count < n; count++)
+			construct(elements + count, d);
+	}
+
+	// Replaces the contents with [first, last), reserving once for forward ranges.
+	template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+	void assign(InputIt first, InputIt last)
+	{
+		clear();
+		using category = typename std::iterator_traits<InputIt>::iterator_category;
+		if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+			reserve(std::distance(first, last));
+		for (; first != last; ++first)
+			emplace_back(*first);
 	}
 
-	void swap(vector<T>& rhs)
+	// Scans, vectorized for arithmetic T (see simd_scan.h).
+	iterator find(const T& d) { return const_cast<iterator>(simd::find(cbegin(), cend(), d)); }
+	const_iterator find(const T& d) const { return simd::find(cbegin(), cend(), d); }
+	size_t count_of(const T& d) const { return simd::count(cbegin(), cend(), d); }
+	bool contains(const T& d) const { return simd::contains(cbegin(), cend(), d); }
+	iterator min_element() { return const_cast<iterator>(simd::min_element(cbegin(), cend())); }
+	const_iterator min_element() const { return simd::min_element(cbegin(), cend()); }
+	iterator max_element() { return const_cast<iterator>(simd::max_element(cbegin(), cend())); }
+	const_iterator max_element() const { return simd::max_element(cbegin(), cend()); }
+	simd::sum_type<T> sum() const { return simd::sum(cbegin(), cend()); }
+
+	// Allocators are exchanged only if they propagate on swap, otherwise they must compare equal.
+	void swap(vector<T, Allocator>& rhs) noexcept
 	{
+		if constexpr (alloc_traits::propagate_on_container_swap::value)
+			std::swap(alloc, rhs.alloc);
 		std::swap(count, rhs.count);
 		std::swap(reservedSize, rhs.reservedSize);
 		std::swap(elements, rhs.elements);
@@ -138,84 +356,317 @@ public:
 
 	size_t size() const noexcept { return count; }
 	bool empty() const noexcept { return count == 0; }
-	size_t max_size() const noexcept { return std::numeric_limits<size_t>::max(); }
+	size_t max_size() const noexcept { return std::min<size_t>(alloc_traits::max_size(alloc), std::numeric_limits<size_t>::max() / sizeof(T)); }
 	size_t capacity() const noexcept { return reservedSize; }
 
-	void reserve(size_t n) 
+	// Grows capacity to at least n, never shrinks.
+	void reserve(size_t n)
 	{
-		std::unique_ptr<T[]> newElements(static_cast<T*>(elements.release()));
-		elements.reset(new T[reservedSize]);
+		if (n > reservedSize)
+			reallocate(n);
+	}
 
-		count = std::min(n, count);
-		//std::copy(begin(), (begin() + count), newElements.get());
-		reservedSize = n;
-		elements = std::move(newElements);
+	// Constructs or destroys elements at the end so that size() == n.
+	void resize(size_t n)
+	{
+		while (count > n)
+			destroy(elements + --count);
+		reserve(n);
+		for (; count < n; count++)
+			construct(elements + count);
+	}
+
+	void resize(size_t n, const T& d)
+	{
+		if (n > reservedSize)
+		{
+			T temp(d);
+			reallocate(n);
+			for (; count < n; count++)
+				construct(elements + count, temp);
+			return;
+		}
+		while (count > n)
+			destroy(elements + --count);
+		for (; count < n; count++)
+			construct(elements + count, d);
+	}
+
+	void shrink_to_fit()
+	{
+		if (count < reservedSize && !resize_in_place(count))
+			reallocate(count);
 	}
-	void resize(size_t n) { reserve(n); }
-	void shrink_to_fit() { reserve(count); }
 
 private:
-	// Allocates double the old space.
-	void resize()
+	T* allocate(size_t n) { return n ? alloc_traits::allocate(alloc, n) : nullptr; }
+
+	void deallocate(T* p, size_t n) noexcept
 	{
-		reservedSize = reservedSize ? reservedSize * 2 : 1;
+		if (p)
+			alloc_traits::deallocate(alloc, p, n);
+	}
+
+	// Resizes the current block to n elements without moving it, if the allocator can.
+	bool resize_in_place(size_t n) noexcept
+	{
+		if constexpr (has_resize_in_place<Allocator>::value)
+		{
+			if (elements && n && alloc.resize_in_place(elements, reservedSize, n))
+			{
+				reservedSize = n;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<typename ...Args>
+	void construct(T* p, Args&&... args) { alloc_traits::construct(alloc, p, std::forward<Args>(args)...); }
+	void destroy(T* p) noexcept { alloc_traits::destroy(alloc, p); }
 
-		std::unique_ptr<T[]> temp(static_cast<T*>(elements.release()));
-		elements.reset(new T[reservedSize]);
-		std::copy(temp.get(), (temp.get() + count), elements.get());
+	// Frees storage, elements must already be destroyed.
+	void release() noexcept
+	{
+		deallocate(elements, reservedSize);
+		elements = nullptr;
+		reservedSize = 0;
+	}
+
+	// Takes rhs's storage, this must hold none.
+	void steal(vector& rhs) noexcept
+	{
+		count = rhs.count;
+		reservedSize = rhs.reservedSize;
+		elements = rhs.elements;
+		rhs.count = rhs.reservedSize = 0;
+		rhs.elements = nullptr;
+	}
+
+	// Copies rhs's elements into this empty vector.
+	void copy_from(const vector& rhs)
+	{
+		reserve(rhs.count);
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			if (rhs.count)
+				std::memcpy(static_cast<void*>(elements), static_cast<const void*>(rhs.elements), rhs.count * sizeof(T));
+			count = rhs.count;
+		}
+		else
+		{
+			for (; count < rhs.count; count++)
+				construct(elements + count, rhs.elements[count]);
+		}
+	}
+
+	// Range insert into a new buffer: [0, i) and [i, count) are relocated around
+	// the n new elements. The old buffer stays valid until the copy is complete.
+	template<typename ForwardIt>
+	void insert_reallocate(size_t i, size_t n, ForwardIt first, ForwardIt last)
+	{
+		size_t newSize = std::max(count + n, next_capacity());
+		if (resize_in_place(newSize))
+			return insert_in_place(i, n, first, last);
+
+		T* newElements = allocate(newSize);
+		T* out = newElements + i;
+
+		try
+		{
+			for (; first != last; ++first, ++out)
+				construct(out, *first);
+		}
+		catch (...)
+		{
+			for (T* p = newElements + i; p != out; ++p)
+				destroy(p);
+			deallocate(newElements, newSize);
+			throw;
+		}
+
+		// Relocation only throws on the copy path, which leaves its source intact. A
+		// failure on the prefix after the suffix moved drops the suffix (basic guarantee).
+		size_t relocated = 0;
+		try
+		{
+			uninitialized_relocate(alloc, elements + i, elements + count, newElements + i + n);
+			relocated = count - i;
+			uninitialized_relocate(alloc, elements, elements + i, newElements);
+		}
+		catch (...)
+		{
+			for (T* p = newElements + i; p != newElements + i + n + relocated; ++p)
+				destroy(p);
+			deallocate(newElements, newSize);
+			if (relocated)
+				count = i;
+			throw;
+		}
+
+		deallocate(elements, reservedSize);
+		elements = newElements;
+		reservedSize = newSize;
+		count += n;
+	}
+
+	// Range insert with sufficient capacity. Trivially copyable elements are shifted
+	// with one memmove, others are moved backward so no live element is overwritten.
+	template<typename ForwardIt>
+	void insert_in_place(size_t i, size_t n, ForwardIt first, ForwardIt last)
+	{
+		T* pos = elements + i;
+		T* oldEnd = elements + count;
+		size_t after = count - i;
+
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos), after * sizeof(T));
+			std::copy(first, last, pos);
+			count += n;
+		}
+		else if (after > n)
+		{
+			for (T* p = oldEnd - n; p != oldEnd; ++p, ++count)
+				construct(elements + count, std::move(*p));
+			std::move_backward(pos, oldEnd - n, oldEnd);
+			std::copy(first, last, pos);
+		}
+		else
+		{
+			ForwardIt mid = first;
+			std::advance(mid, after);
+			for (ForwardIt it = mid; it != last; ++it, ++count)
+				construct(elements + count, *it);
+			for (T* p = pos; p != oldEnd; ++p, ++count)
+				construct(elements + count, std::move(*p));
+			std::copy(first, mid, pos);
+		}
+	}
+
+	// Doubles the old space.
+	size_t next_capacity() const noexcept { return reservedSize ? reservedSize * 2 : 1; }
+
+	// Moves contents into a fresh buffer of n elements (n >= count), unless the allocator
+	// can grow the current one in place.
+	void reallocate(size_t n)
+	{
+		if (n > reservedSize && resize_in_place(n))
+			return;
+
+		T* newElements = allocate(n);
+
+		try
+		{
+			uninitialized_relocate(alloc, elements, elements + count, newElements);
+		}
+		catch (...)
+		{
+			deallocate(newElements, n);
+			throw;
+		}
+
+		deallocate(elements, reservedSize);
+		elements = newElements;
+		reservedSize = n;
+	}
+
+	// Slow path of emplace_back. New element is constructed before the old ones are
+	// relocated, so args referring into this vector stay valid.
+	template<typename ...Args>
+	T& grow_emplace_back(Args&&... args)
+	{
+		size_t newSize = next_capacity();
+		if (resize_in_place(newSize))
+		{
+			construct(elements + count, std::forward<Args>(args)...);
+			return elements[count++];
+		}
+
+		T* newElements = allocate(newSize);
+
+		try
+		{
+			construct(newElements + count, std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			deallocate(newElements, newSize);
+			throw;
+		}
+
+		try
+		{
+			uninitialized_relocate(alloc, elements, elements + count, newElements);
+		}
+		catch (...)
+		{
+			destroy(newElements + count);
+			deallocate(newElements, newSize);
+			throw;
+		}
+
+		deallocate(elements, reservedSize);
+		elements = newElements;
+		reservedSize = newSize;
+
+		return elements[count++];
 	}
 };
 
-template <typename T>
-bool operator== (const vector<T>& lhs, const vector<T>& rhs)
+template <typename T, typename Allocator>
+bool operator== (const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
 {
 	if (lhs.count != rhs.count)
 		return false;
 
-	for (size_t i = 0; i < lhs.count; i++)
-		if (lhs[i] != rhs[i])
-			return false;
-
-	return true;
+	return simd::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template<typename T>
-bool operator!= (const vector<T>& lhs, const vector<T>& rhs)
+template<typename T, typename Allocator>
+bool operator!= (const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
 {
 	return !(lhs == rhs);
 }
 
-template<typename T>
-bool operator< (const vector<T>& lhs, const vector<T>& rhs)
+template<typename T, typename Allocator>
+bool operator< (const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
 {
-	typename vector<T>::size_type n = (lhs.count < rhs.count) ? lhs.count : rhs.count;
-	
-	for (size_t i = 0; i < n; i++)
-		if (lhs[i] != rhs[i])
-			return lhs[i] < rhs[i];
-	
+	typename vector<T, Allocator>::size_type n = (lhs.count < rhs.count) ? lhs.count : rhs.count;
+	typename vector<T, Allocator>::size_type i = simd::mismatch(lhs.begin(), lhs.begin() + n, rhs.begin()) - lhs.begin();
+
+	if (i < n)
+		return lhs[i] < rhs[i];
+
 	return lhs.count < rhs.count;
 }
 
-template<typename T>
-bool operator> (const vector<T>& lhs, const vector<T>& rhs)
+template<typename T, typename Allocator>
+bool operator> (const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
 {
-	typename vector<T>::size_type n = lhs.count < rhs.count ? lhs.count : rhs.count;
+	typename vector<T, Allocator>::size_type n = lhs.count < rhs.count ? lhs.count : rhs.count;
+	typename vector<T, Allocator>::size_type i = simd::mismatch(lhs.begin(), lhs.begin() + n, rhs.begin()) - lhs.begin();
 
-	for (size_t i = 0; i < n; i++)
-		if (lhs[i] != rhs[i])
-			return lhs[i] > rhs[i];
+	if (i < n)
+		return lhs[i] > rhs[i];
 
 	return lhs.count > rhs.count;
 }
 
-template<typename T>
-bool operator<= (const vector<T>& lhs, const vector<T>& rhs) { return !(lhs > rhs); }
+template<typename T, typename Allocator>
+bool operator<= (const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs) { return !(lhs > rhs); }
+
+template<typename T, typename Allocator>
+bool operator>= (const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs) { return !(lhs < rhs); }
 
-template<typename T>
-bool operator>= (const vector<T>& lhs, const vector<T>& rhs) { return !(lhs < rhs); }
+template<typename T, typename Allocator>
+void swap(vector<T, Allocator>& lhs, vector<T, Allocator>& rhs) { lhs.swap(rhs); }
 
-template<typename T>
-void swap(vector<T>& lhs, vector<T>& rhs) { lhs.swap(rhs); }
+namespace pmr
+{
+	// Vector drawing its storage from a std::pmr::memory_resource.
+	template <typename T>
+	using vector = ::vector<T, std::pmr::polymorphic_allocator<T>>;
+}
 
 #endif
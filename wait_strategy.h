@@ -0,0 +1,199 @@
+// Wait strategies for blocking on a lock-free structure. A waiter calls
+// wait(ready, deadline), where ready() retries the operation and returns true once it succeeded;
+// whoever makes progress possible calls notify_one() (one element, one waiter can use it) or
+// notify() (bulk progress or shutdown; wakes everybody).
+//   busy_spin_wait  - spins with a pause instruction; lowest latency, burns a core.
+//   spin_yield_wait - spins briefly, then yields the time slice between retries.
+//   park_wait       - spins briefly, then sleeps on a futex (a condition variable off Linux).
+//                     notify() costs a fence and a load unless somebody is parked.
+#ifndef _WAIT_STRATEGY_H_
+#define _WAIT_STRATEGY_H_
+
+#include <atomic>  // atomic, atomic_thread_fence
+#include <chrono>  // steady_clock
+#include <cstdint> // uint32_t
+#include <thread>  // yield
+
+#if defined(__linux__)
+#include <climits>       // INT_MAX
+#include <ctime>         // timespec
+#include <linux/futex.h> // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h> // SYS_futex
+#include <unistd.h>      // syscall
+#else
+#include <condition_variable> // condition_variable
+#include <mutex>              // mutex
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h> // _mm_pause
+#endif
+
+namespace wait_detail
+{
+	// Tells the core this is a spin loop.
+	inline void cpu_relax() noexcept
+	{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+
+	using clock = std::chrono::steady_clock;
+
+	// Spins up to n times on ready(); true as soon as it succeeds.
+	template <typename Ready>
+	bool spin(Ready& ready, unsigned n)
+	{
+		for (unsigned i = 0; i < n; ++i)
+		{
+			if (ready())
+				return true;
+			cpu_relax();
+		}
+		return false;
+	}
+}
+
+struct busy_spin_wait
+{
+	template <typename Ready>
+	bool wait(Ready ready, wait_detail::clock::time_point deadline)
+	{
+		for (;;)
+		{
+			if (wait_detail::spin(ready, 64))
+				return true;
+			if (wait_detail::clock::now() >= deadline)
+				return ready();
+		}
+	}
+
+	void notify_one() noexcept { }
+	void notify() noexcept { }
+};
+
+struct spin_yield_wait
+{
+	static constexpr unsigned spins = 256;
+
+	template <typename Ready>
+	bool wait(Ready ready, wait_detail::clock::time_point deadline)
+	{
+		if (wait_detail::spin(ready, spins))
+			return true;
+		for (;;)
+		{
+			std::this_thread::yield();
+			if (ready())
+				return true;
+			if (wait_detail::clock::now() >= deadline)
+				return false;
+		}
+	}
+
+	void notify_one() noexcept { }
+	void notify() noexcept { }
+};
+
+// Eventcount: a waiter registers, reads the epoch, retries once more and only then sleeps
+// until the epoch moves. The seq_cst fences on both sides make sure that either the waiter's
+// retry sees the notifier's progress or the notifier sees the registered waiter and bumps the
+// epoch (release; the waiter reads it with acquire, so a new epoch implies visible progress).
+class park_wait
+{
+	std::atomic<std::uint32_t> epoch{ 0 };
+	std::atomic<std::uint32_t> waiters{ 0 };
+#if !defined(__linux__)
+	std::mutex m;
+	std::condition_variable cv;
+#endif
+
+	// Sleeps while epoch == e, at most until deadline. May return early.
+	void sleep(std::uint32_t e, wait_detail::clock::time_point deadline)
+	{
+#if defined(__linux__)
+		timespec ts;
+		timespec* timeout = nullptr;
+		if (deadline != wait_detail::clock::time_point::max())
+		{
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - wait_detail::clock::now()).count();
+			if (ns <= 0)
+				return;
+			ts.tv_sec = time_t(ns / 1000000000);
+			ts.tv_nsec = long(ns % 1000000000);
+			timeout = &ts;
+		}
+		syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, e, timeout, nullptr, 0);
+#else
+		std::unique_lock<std::mutex> lock(m);
+		if (deadline == wait_detail::clock::time_point::max())
+			cv.wait(lock, [&] { return epoch.load(std::memory_order_relaxed) != e; });
+		else
+			cv.wait_until(lock, deadline, [&] { return epoch.load(std::memory_order_relaxed) != e; });
+#endif
+	}
+
+public:
+	static constexpr unsigned spins = 128;
+
+	template <typename Ready>
+	bool wait(Ready ready, wait_detail::clock::time_point deadline)
+	{
+		if (wait_detail::spin(ready, spins))
+			return true;
+
+		for (;;)
+		{
+			waiters.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			std::uint32_t e = epoch.load(std::memory_order_acquire);
+
+			bool done = ready();
+			if (!done && wait_detail::clock::now() < deadline)
+			{
+				sleep(e, deadline);
+				done = ready();
+			}
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+
+			if (done)
+				return true;
+			if (wait_detail::clock::now() >= deadline)
+				return false;
+		}
+	}
+
+	// Wakes one parked waiter. Waiters registered but not yet asleep see the new epoch and
+	// retry as well, so no progress is missed.
+	void notify_one() noexcept { wake(false); }
+
+	// Wakes every parked waiter; they race to retry, and the losers park again.
+	void notify() noexcept { wake(true); }
+
+private:
+	void wake(bool all) noexcept
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_relaxed) == 0)
+			return;
+
+#if defined(__linux__)
+		epoch.fetch_add(1, std::memory_order_release);
+		syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr, nullptr, 0);
+#else
+		{
+			std::lock_guard<std::mutex> lock(m);
+			epoch.fetch_add(1, std::memory_order_release);
+		}
+		if (all)
+			cv.notify_all();
+		else
+			cv.notify_one();
+#endif
+	}
+};
+
+#endif
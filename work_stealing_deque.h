@@ -0,0 +1,141 @@
+// Chase-Lev work-stealing deque (with the C11 memory orders of Le, Pop, Cohen and Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models", 2013). The owning thread pushes
+// and pops at the bottom, LIFO; any other thread steals from the top, FIFO. The owner only
+// synchronizes with thieves when one element is left. The buffer doubles when full; thieves may
+// still be reading an old buffer, so replaced buffers are kept until the deque is destroyed
+// (at most as much memory again as the current buffer).
+// T must be trivially copyable; typically a pointer.
+#ifndef _WORK_STEALING_DEQUE_H_
+#define _WORK_STEALING_DEQUE_H_
+
+#include <atomic>      // atomic, atomic_thread_fence
+#include <cstddef>     // ptrdiff_t, size_t
+#include <type_traits> // is_trivially_copyable
+
+template <typename T>
+class work_stealing_deque
+{
+	static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque needs a trivially copyable T");
+
+	static constexpr std::size_t cacheLine = 64;
+
+	struct Buffer
+	{
+		std::ptrdiff_t mask;
+		std::atomic<T>* slots;
+		Buffer* previous; // Replaced buffer, freed with this one.
+
+		explicit Buffer(std::ptrdiff_t capacity, Buffer* previous = nullptr) : mask(capacity - 1), slots(new std::atomic<T>[capacity]), previous(previous) { }
+		~Buffer() { delete[] slots; }
+
+		std::ptrdiff_t capacity() const { return mask + 1; }
+		T get(std::ptrdiff_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+		void put(std::ptrdiff_t i, T x) { slots[i & mask].store(x, std::memory_order_relaxed); }
+	};
+
+	alignas(cacheLine) std::atomic<std::ptrdiff_t> top;    // Thieves take here.
+	alignas(cacheLine) std::atomic<std::ptrdiff_t> bottom; // Owner pushes and pops here.
+	std::atomic<Buffer*> buffer;
+
+	// Owner only: copies [t, b) into a buffer twice as large.
+	Buffer* grow(Buffer* a, std::ptrdiff_t b, std::ptrdiff_t t)
+	{
+		Buffer* bigger = new Buffer(a->capacity() * 2, a);
+		for (std::ptrdiff_t i = t; i != b; ++i)
+			bigger->put(i, a->get(i));
+		buffer.store(bigger, std::memory_order_release);
+		return bigger;
+	}
+
+public:
+	// Capacity is rounded up to a power of two.
+	explicit work_stealing_deque(std::size_t capacity = 256) : top(0), bottom(0)
+	{
+		std::ptrdiff_t n = 2;
+		while (std::size_t(n) < capacity)
+			n *= 2;
+		buffer.store(new Buffer(n), std::memory_order_relaxed);
+	}
+
+	work_stealing_deque(const work_stealing_deque&) = delete;
+	work_stealing_deque& operator= (const work_stealing_deque&) = delete;
+
+	~work_stealing_deque()
+	{
+		for (Buffer* a = buffer.load(std::memory_order_relaxed); a; )
+		{
+			Buffer* previous = a->previous;
+			delete a;
+			a = previous;
+		}
+	}
+
+	// Approximate unless called by the owner with no thief active.
+	std::size_t size() const
+	{
+		std::ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+		std::ptrdiff_t t = top.load(std::memory_order_relaxed);
+		return b > t ? std::size_t(b - t) : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	std::size_t capacity() const { return std::size_t(buffer.load(std::memory_order_relaxed)->capacity()); }
+
+	// Owner only.
+	void push(T x)
+	{
+		std::ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+		std::ptrdiff_t t = top.load(std::memory_order_acquire);
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+		if (b - t > a->mask)
+			a = grow(a, b, t);
+		a->put(b, x);
+		bottom.store(b + 1, std::memory_order_release);
+	}
+
+	// Owner only. Takes the most recently pushed element; false when the deque is empty.
+	bool pop(T& result)
+	{
+		std::ptrdiff_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::ptrdiff_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		result = a->get(b);
+		if (t == b)
+		{
+			// Last element: race the thieves for it.
+			bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	// Any thread. Takes the oldest element; false when the deque is empty or another thread
+	// got it first.
+	bool steal(T& result)
+	{
+		std::ptrdiff_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::ptrdiff_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return false;
+
+		Buffer* a = buffer.load(std::memory_order_acquire);
+		T x = a->get(t);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return false;
+		result = x;
+		return true;
+	}
+};
+
+#endif